@@ -0,0 +1,99 @@
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include "PaletteStorage.h"
+
+// Edge length of the engine's chunks, set by the VOXEL_CHUNK_SIZE CMake option.
+// Powers of two index with shifts and masks instead of multiplies.
+#ifndef VOXEL_CHUNK_SIZE
+#define VOXEL_CHUNK_SIZE 16
+#endif
+
+// Sizes the chunk kernels (generation, meshing) are compiled for: the
+// engine's plus the powers of two the benchmarks compare
+#if VOXEL_CHUNK_SIZE == 16 || VOXEL_CHUNK_SIZE == 32 || VOXEL_CHUNK_SIZE == 64
+#define FOR_EACH_CHUNK_SIZE(X) X(16) X(32) X(64)
+#else
+#define FOR_EACH_CHUNK_SIZE(X) X(16) X(32) X(64) X(VOXEL_CHUNK_SIZE)
+#endif
+
+// Chunk rows are bitmasks of up to 64 voxels
+const int MAX_CHUNK_SIZE = 64;
+
+// Block types, 0 is empty space
+const BlockId BLOCK_AIR = 0;
+const BlockId BLOCK_STONE = 1;
+
+constexpr int chunkSizeShift(int size) {
+    int shift = 0;
+    while ((2 << shift) <= size) shift++;
+    return shift;
+}
+
+// A cube of Size^3 voxels. The engine uses Chunk (BasicChunk<CHUNK_SIZE>),
+// other sizes exist for the kernels and benchmarks.
+template <int Size>
+struct BasicChunk {
+    static_assert(Size > 0 && Size <= MAX_CHUNK_SIZE, "chunk rows must fit in a 64-bit mask");
+
+    static constexpr int SIZE = Size;
+    static constexpr int AREA = Size * Size;
+    static constexpr int VOLUME = Size * Size * Size;
+    static constexpr bool POWER_OF_TWO = (Size & (Size - 1)) == 0;
+    static constexpr int SHIFT = chunkSizeShift(Size); // powers of two only
+    static constexpr int MASK = Size - 1; // powers of two only
+
+    // One row of voxels as a bitmask, bit i = voxel i along the row
+    using RowMask = std::conditional_t<(Size <= 32), uint32_t, uint64_t>;
+
+    int x, y, z;                  // world position of the chunk's first voxel
+    PaletteStorage blocks;        // palette-compressed block IDs
+    int renderSlot;               // its GPU side in the world's ChunkRenderPool, -1 when it has none (render thread only)
+    bool dirty;                   // mesh needs rebuilding
+    unsigned int meshVersion;     // bumped each time a mesh job is scheduled (render thread only)
+    int occluderBegin, occluderEnd; // fully solid layers [begin, end) used as an occluder (render thread only)
+    uint64_t faceConnections;     // see ChunkVisibility.h, everything connected until first meshed (render thread only)
+    unsigned int visibilityStamp; // last walk that reached this chunk (render thread only)
+    int lod;                      // level of detail the world wants for it (render thread only)
+    int meshLod;                  // level of detail of the uploaded mesh (render thread only)
+
+    std::atomic<bool> generated;  // blocks are filled in, set by the generating worker
+    std::atomic<bool> cancelled;  // chunk was unloaded, pending jobs skip it
+
+    BasicChunk(int x_, int y_, int z_)
+        : x(x_), y(y_), z(z_), blocks(VOLUME, BLOCK_AIR), renderSlot(-1), dirty(true), meshVersion(0),
+          occluderBegin(0), occluderEnd(0), faceConnections(~uint64_t(0)), visibilityStamp(0), lod(0), meshLod(0), generated(false), cancelled(false) {}
+
+    // Linear index, z fastest then x then y so a layer is one contiguous slab
+    static int index(int lx, int ly, int lz) {
+        if constexpr (POWER_OF_TWO) {
+            return (ly << (2 * SHIFT)) | (lx << SHIFT) | lz;
+        } else {
+            return (ly * Size + lx) * Size + lz;
+        }
+    }
+
+    // Local voxel coordinates, no bounds check
+    BlockId get(int lx, int ly, int lz) const {
+        return blocks.get(index(lx, ly, lz));
+    }
+
+    // Only a block that actually changes needs a remesh
+    void set(int lx, int ly, int lz, BlockId block) {
+        if (blocks.set(index(lx, ly, lz), block)) dirty = true;
+    }
+
+    bool isSolid(int lx, int ly, int lz) const {
+        return get(lx, ly, lz) != BLOCK_AIR;
+    }
+};
+
+const int CHUNK_SIZE = VOXEL_CHUNK_SIZE;
+using Chunk = BasicChunk<CHUNK_SIZE>;
+const int CHUNK_VOLUME = Chunk::VOLUME;
+
+#endif //CHUNK_H
@@ -0,0 +1,95 @@
+#include "ChunkMap.h"
+
+ChunkMap::ChunkMap(size_t initialCapacity)
+    : count(0) {
+    size_t capacity = 16;
+    while (capacity < initialCapacity) capacity *= 2;
+    slots.resize(capacity);
+    mask = capacity - 1;
+}
+
+Chunk* ChunkMap::find(const glm::ivec3& coord) const {
+    const Slot& slot = slots[findSlot(coord)];
+    return slot.chunk.get();
+}
+
+std::shared_ptr<Chunk> ChunkMap::findShared(const glm::ivec3& coord) const {
+    return slots[findSlot(coord)].chunk;
+}
+
+Chunk* ChunkMap::insert(const glm::ivec3& coord, std::shared_ptr<Chunk> chunk) {
+    // Keep the load factor under 1/2 so probe sequences stay short
+    if ((count + 1) * 2 > slots.size()) {
+        grow();
+    }
+
+    Slot& slot = slots[findSlot(coord)];
+    if (!slot.chunk) count++;
+    slot.coord = coord;
+    slot.chunk = std::move(chunk);
+    return slot.chunk.get();
+}
+
+std::shared_ptr<Chunk> ChunkMap::erase(const glm::ivec3& coord) {
+    size_t hole = findSlot(coord);
+    if (!slots[hole].chunk) return nullptr;
+
+    std::shared_ptr<Chunk> removed = std::move(slots[hole].chunk);
+    count--;
+
+    // Shift later entries of the probe run back into the hole
+    size_t i = hole;
+    while (true) {
+        i = (i + 1) & mask;
+        if (!slots[i].chunk) break;
+
+        const size_t home = hash(slots[i].coord) & mask;
+        // Move the entry if its home slot is not cyclically within (hole, i]
+        const bool inRange = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+        if (!inRange) {
+            slots[hole].coord = slots[i].coord;
+            slots[hole].chunk = std::move(slots[i].chunk);
+            hole = i;
+        }
+    }
+    return removed;
+}
+
+void ChunkMap::clear() {
+    for (Slot& slot : slots) {
+        slot.chunk.reset();
+    }
+    count = 0;
+}
+
+uint32_t ChunkMap::hash(const glm::ivec3& coord) {
+    uint32_t h = static_cast<uint32_t>(coord.x) * 73856093u
+               ^ static_cast<uint32_t>(coord.y) * 19349663u
+               ^ static_cast<uint32_t>(coord.z) * 83492791u;
+    // Final avalanche so nearby coordinates spread over the table
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+size_t ChunkMap::findSlot(const glm::ivec3& coord) const {
+    size_t i = hash(coord) & mask;
+    while (slots[i].chunk && slots[i].coord != coord) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void ChunkMap::grow() {
+    std::vector<Slot> old = std::move(slots);
+    slots = std::vector<Slot>(old.size() * 2);
+    mask = slots.size() - 1;
+    for (Slot& slot : old) {
+        if (slot.chunk) {
+            slots[findSlot(slot.coord)] = std::move(slot);
+        }
+    }
+}
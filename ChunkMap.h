@@ -0,0 +1,48 @@
+#ifndef CHUNKMAP_H
+#define CHUNKMAP_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+
+// Open-addressing hash map from integer chunk coordinates to chunks. Chunks are
+// shared so jobs still working on an unloaded chunk keep it alive.
+// Linear probing over a power-of-two table, erase uses backward shifting so
+// no tombstones build up while the camera streams chunks in and out.
+class ChunkMap {
+public:
+    explicit ChunkMap(size_t initialCapacity = 256);
+
+    Chunk* find(const glm::ivec3& coord) const;
+    std::shared_ptr<Chunk> findShared(const glm::ivec3& coord) const;
+    Chunk* insert(const glm::ivec3& coord, std::shared_ptr<Chunk> chunk);
+    std::shared_ptr<Chunk> erase(const glm::ivec3& coord);
+    void clear();
+
+    size_t size() const { return count; }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const Slot& slot : slots) {
+            if (slot.chunk) fn(slot.coord, *slot.chunk);
+        }
+    }
+
+private:
+    struct Slot {
+        glm::ivec3 coord;
+        std::shared_ptr<Chunk> chunk; // nullptr = empty slot
+    };
+
+    static uint32_t hash(const glm::ivec3& coord);
+    size_t findSlot(const glm::ivec3& coord) const; // index of coord or of the empty slot ending its probe
+    void grow();
+
+    std::vector<Slot> slots;
+    size_t mask;
+    size_t count;
+};
+
+#endif //CHUNKMAP_H
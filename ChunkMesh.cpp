@@ -0,0 +1,40 @@
+#include "ChunkMesh.h"
+
+MeshPool* ChunkMesh::pool = nullptr;
+
+ChunkMesh::ChunkMesh() {}
+
+void ChunkMesh::initSharedBuffers(int maxQuads) {
+    // 1024 pages = 256K vertices (1 MB) to start with, grows on demand
+    pool = new MeshPool(maxQuads, 1024);
+}
+
+void ChunkMesh::cleanupSharedBuffers() {
+    if (pool == nullptr) return;
+    pool->cleanup();
+    delete pool;
+    pool = nullptr;
+}
+
+int ChunkMesh::drawQueued(unsigned int shaderProgram) {
+    return pool->drawQueued(shaderProgram);
+}
+
+void ChunkMesh::upload(const std::vector<ChunkVertex>& vertices, const glm::vec3& origin, float scale) {
+    // Meshes are replaced whole
+    pool->release(allocation);
+    allocation = pool->allocate(vertices, origin, scale);
+}
+
+void ChunkMesh::upload(UploadRing& ring, UploadSpan& span, const glm::vec3& origin, float scale) {
+    pool->release(allocation);
+    allocation = pool->allocate(ring, span, origin, scale);
+}
+
+void ChunkMesh::queueDraw() const {
+    pool->queue(allocation);
+}
+
+void ChunkMesh::cleanup() {
+    if (pool != nullptr) pool->release(allocation);
+}
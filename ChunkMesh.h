@@ -0,0 +1,37 @@
+#ifndef CHUNKMESH_H
+#define CHUNKMESH_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "MeshPool.h"
+
+// GPU side of a chunk mesh: its pages in the MeshPool shared by all chunks.
+// Faces are 4 vertices each, drawn through the pool's shared index buffer.
+class ChunkMesh {
+public:
+    ChunkMesh();
+
+    // Shared pool, create once the GL context exists
+    static void initSharedBuffers(int maxQuads);
+    static void cleanupSharedBuffers();
+    static const MeshPool* sharedPool() { return pool; }
+
+    // Draw every mesh queued since the last call, returns the number of draw calls
+    static int drawQueued(unsigned int shaderProgram);
+
+    // origin is the world position of the chunk's min corner, scale the world
+    // size of a vertex coordinate step (1 = one voxel)
+    void upload(const std::vector<ChunkVertex>& vertices, const glm::vec3& origin, float scale = 1.0f);
+    void upload(UploadRing& ring, UploadSpan& span, const glm::vec3& origin, float scale = 1.0f);
+    void queueDraw() const;
+    void cleanup();
+
+    int triangleCount() const { return allocation.quadCount * 2; }
+
+private:
+    static MeshPool* pool;
+
+    MeshPool::Allocation allocation;
+};
+
+#endif //CHUNKMESH_H
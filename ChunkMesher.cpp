@@ -0,0 +1,632 @@
+#include "ChunkMesher.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <limits>
+#include <type_traits>
+#include "SparseVoxelOctree.h"
+
+static_assert(MAX_CHUNK_SIZE <= CHUNK_VERTEX_MAX_COORD, "packed vertices need corner coordinates up to the chunk size");
+
+namespace {
+
+// Unit offset for each face direction: -X, +X, -Y, +Y, -Z, +Z
+const int faceDirections[6][3] = {
+    {-1, 0, 0}, {1, 0, 0},
+    {0, -1, 0}, {0, 1, 0},
+    {0, 0, -1}, {0, 0, 1},
+};
+
+// Quad corners of each face on the unit cube, counter-clockwise seen from outside
+const int faceCorners[6][4][3] = {
+    {{0, 0, 0}, {0, 0, 1}, {0, 1, 1}, {0, 1, 0}}, // -X
+    {{1, 0, 0}, {1, 1, 0}, {1, 1, 1}, {1, 0, 1}}, // +X
+    {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}}, // -Y
+    {{0, 1, 0}, {0, 1, 1}, {1, 1, 1}, {1, 1, 0}}, // +Y
+    {{0, 0, 0}, {0, 1, 0}, {1, 1, 0}, {1, 0, 0}}, // -Z
+    {{0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}}, // +Z
+};
+
+// The chunk's blocks decoded once up front, so the meshers don't pay for
+// palette lookups on every neighbour test. On the heap, a 64^3 chunk is 512 KB.
+template <int Size>
+struct MeshSource {
+    const BasicChunk<Size>& chunk;
+    const BasicChunkNeighbours<Size>& neighbours;
+    std::vector<BlockId> blocks;
+
+    MeshSource(const BasicChunk<Size>& chunk_, const BasicChunkNeighbours<Size>& neighbours_)
+        : chunk(chunk_), neighbours(neighbours_), blocks(BasicChunk<Size>::VOLUME) {
+        chunk.blocks.unpack(blocks.data());
+    }
+
+    BlockId get(int x, int y, int z) const {
+        return blocks[BasicChunk<Size>::index(x, y, z)];
+    }
+
+    // Solid test for local coordinates that may be one step outside the chunk
+    bool isSolidAt(int x, int y, int z) const {
+        const BasicChunk<Size>* target;
+        if (x < 0)          { target = neighbours[0]; x += Size; }
+        else if (x >= Size) { target = neighbours[1]; x -= Size; }
+        else if (y < 0)     { target = neighbours[2]; y += Size; }
+        else if (y >= Size) { target = neighbours[3]; y -= Size; }
+        else if (z < 0)     { target = neighbours[4]; z += Size; }
+        else if (z >= Size) { target = neighbours[5]; z -= Size; }
+        else return get(x, y, z) != BLOCK_AIR;
+
+        return target != nullptr && target->isSolid(x, y, z);
+    }
+
+    // Step through blocks to the voxel across each face, see BasicChunk::index
+    static constexpr int faceStrides[6] = {-Size, Size, -BasicChunk<Size>::AREA, BasicChunk<Size>::AREA, -1, 1};
+
+    // Whether a solid voxel covers the given face of voxel (x, y, z). Only
+    // the chunk's outer layer needs the neighbours, everything inside is a
+    // constant step through blocks.
+    bool isFaceHidden(int face, int x, int y, int z) const {
+        bool border;
+        switch (face) {
+            case 0: border = x == 0; break;
+            case 1: border = x == Size - 1; break;
+            case 2: border = y == 0; break;
+            case 3: border = y == Size - 1; break;
+            case 4: border = z == 0; break;
+            default: border = z == Size - 1; break;
+        }
+        if (border) {
+            const int* d = faceDirections[face];
+            return isSolidAt(x + d[0], y + d[1], z + d[2]);
+        }
+        return blocks[BasicChunk<Size>::index(x, y, z) + faceStrides[face]] != BLOCK_AIR;
+    }
+};
+
+// A chunk downsampled to LOD cells, plus its same-LOD neighbours for the
+// border faces. Cells are indexed like Chunk::index with n cells per axis.
+struct LodSource {
+    int n;
+    std::vector<BlockId> cells;
+    std::array<std::vector<BlockId>, 6> neighbourCells; // empty = empty space
+
+    LodSource(const Chunk& chunk, const ChunkNeighbours& neighbours, int lod)
+        : n(lodCellCount(lod)) {
+        downsampleChunk(chunk, lod, cells);
+        for (int i = 0; i < 6; i++) {
+            if (neighbours[i] != nullptr) downsampleChunk(*neighbours[i], lod, neighbourCells[i]);
+        }
+    }
+
+    BlockId get(int x, int y, int z) const {
+        return cells[(y * n + x) * n + z];
+    }
+
+    bool isSolidAt(int x, int y, int z) const {
+        const std::vector<BlockId>* target;
+        if (x < 0)       { target = &neighbourCells[0]; x += n; }
+        else if (x >= n) { target = &neighbourCells[1]; x -= n; }
+        else if (y < 0)  { target = &neighbourCells[2]; y += n; }
+        else if (y >= n) { target = &neighbourCells[3]; y -= n; }
+        else if (z < 0)  { target = &neighbourCells[4]; z += n; }
+        else if (z >= n) { target = &neighbourCells[5]; z -= n; }
+        else return get(x, y, z) != BLOCK_AIR;
+
+        return !target->empty() && (*target)[(y * n + x) * n + z] != BLOCK_AIR;
+    }
+
+    bool isFaceHidden(int face, int x, int y, int z) const {
+        const int* d = faceDirections[face];
+        return isSolidAt(x + d[0], y + d[1], z + d[2]);
+    }
+};
+
+// Per-thread buffers of buildBinaryGreedyMesh, reused from chunk to chunk.
+// Column (i, j) of an axis runs along the axis at coordinate i on its u axis
+// and j on its v axis (as in greedyMesh) and is stored at j * Size + i.
+template <int Size>
+struct BinaryMeshScratch {
+    using RowMask = typename BasicChunk<Size>::RowMask;
+
+    std::vector<uint64_t> voxels; // one bit per voxel, see PaletteStorage::matchMask
+    std::vector<BlockId> types;   // solid block types in the chunk
+    std::vector<RowMask> solid;  // columns of the 3 axes, any solid block
+    std::vector<RowMask> typed;  // columns of the 3 axes per type, only with several types
+    std::vector<RowMask> planes; // visible faces of one direction: per type and slice, a row over u per v
+};
+
+// Transpose a square bit matrix in place, bit c of row r swaps with bit r of
+// row c (Hacker's Delight 7-3, with bit 0 as the first column)
+template <typename RowMask>
+void transposeBits(RowMask* rows) {
+    constexpr int BITS = std::numeric_limits<RowMask>::digits;
+    RowMask mask = std::numeric_limits<RowMask>::max() >> (BITS / 2);
+    for (int j = BITS / 2; j != 0; j >>= 1, mask ^= mask << j) {
+        for (int k = 0; k < BITS; k = ((k | j) + 1) & ~j) {
+            const RowMask t = ((rows[k] >> j) ^ rows[k | j]) & mask;
+            rows[k] ^= t << j;
+            rows[k | j] ^= t;
+        }
+    }
+}
+
+// Columns of the three axes from a bitset of voxels in index order, laid out
+// as in BinaryMeshScratch::solid. The z columns are runs of the bitset, the x
+// and y ones are transposes of them a layer at a time.
+template <int Size>
+void buildColumns(const uint64_t* voxels, typename BasicChunk<Size>::RowMask* columns) {
+    using RowMask = typename BasicChunk<Size>::RowMask;
+    constexpr int AREA = BasicChunk<Size>::AREA;
+    constexpr int BITS = std::numeric_limits<RowMask>::digits;
+    constexpr uint64_t ROW_BITS = Size == 64 ? ~uint64_t(0) : (uint64_t(1) << Size) - 1;
+
+    // z axis: u = x, v = y, so column y * Size + x is run y * Size + x of the
+    // bitset. Runs only straddle two words when Size doesn't divide 64.
+    RowMask* zColumns = columns + 2 * AREA;
+    for (int row = 0; row < AREA; row++) {
+        const int first = row * Size;
+        const int shift = first & 63;
+        uint64_t run = voxels[first >> 6] >> shift;
+        if (shift + Size > 64) run |= voxels[(first >> 6) + 1] << (64 - shift);
+        zColumns[row] = static_cast<RowMask>(run & ROW_BITS);
+    }
+
+    std::array<RowMask, BITS> matrix;
+    // x axis: u = y, v = z. For each y, rows x of z bits become rows z of x bits.
+    for (int y = 0; y < Size; y++) {
+        std::copy(zColumns + y * Size, zColumns + (y + 1) * Size, matrix.begin());
+        std::fill(matrix.begin() + Size, matrix.end(), 0);
+        transposeBits(matrix.data());
+        for (int z = 0; z < Size; z++) {
+            columns[z * Size + y] = matrix[z];
+        }
+    }
+    // y axis: u = z, v = x. For each x, rows y of z bits become rows z of y bits.
+    for (int x = 0; x < Size; x++) {
+        for (int y = 0; y < Size; y++) {
+            matrix[y] = zColumns[y * Size + x];
+        }
+        std::fill(matrix.begin() + Size, matrix.end(), 0);
+        transposeBits(matrix.data());
+        std::copy(matrix.begin(), matrix.begin() + Size, columns + AREA + x * Size);
+    }
+}
+
+// Ambient occlusion of a quad's corners, 2 bits each in faceCorners order
+// (see packChunkVertex). A corner counts the solid voxels among the two along
+// the quad's edges and the diagonal one, in the layer in front of the face,
+// and is fully occluded when both edge voxels are. Only the quad's own
+// corners are sampled, so a merged quad interpolates between them.
+// solidAt(x, y, z) answers for a grid of n cells per axis plus one cell past
+// each face; cells past two faces (diagonal chunks) count as empty.
+template <typename SolidFn>
+unsigned int quadOcclusion(const SolidFn& solidAt, int n, int face, const int minCorner[3], const int size[3]) {
+    const int axis = face / 2;
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+
+    int pos[3];
+    pos[axis] = (face & 1) ? minCorner[axis] + size[axis] : minCorner[axis] - 1;
+    auto solid = [&](int cu, int cv) {
+        pos[u] = cu;
+        pos[v] = cv;
+        int outside = 0;
+        for (int a = 0; a < 3; a++) {
+            if (pos[a] < 0 || pos[a] >= n) outside++;
+        }
+        return outside <= 1 && solidAt(pos[0], pos[1], pos[2]) ? 1u : 0u;
+    };
+
+    unsigned int occlusion = 0;
+    for (int i = 0; i < 4; i++) {
+        const int* corner = faceCorners[face][i];
+        // Cells just past the quad at this corner and the quad's own edge cells
+        const int outU = corner[u] ? minCorner[u] + size[u] : minCorner[u] - 1;
+        const int edgeU = corner[u] ? minCorner[u] + size[u] - 1 : minCorner[u];
+        const int outV = corner[v] ? minCorner[v] + size[v] : minCorner[v] - 1;
+        const int edgeV = corner[v] ? minCorner[v] + size[v] - 1 : minCorner[v];
+        const unsigned int sideU = solid(outU, edgeV);
+        const unsigned int sideV = solid(edgeU, outV);
+        const unsigned int level = sideU && sideV ? 3u : sideU + sideV + solid(outU, outV);
+        occlusion |= level << (2 * i);
+    }
+    return occlusion;
+}
+
+// Face attribute (the block type) of voxel (x, y, z) looking along face, 0 if the face is hidden
+template <typename Source>
+int faceAttribute(const Source& source, int face, int x, int y, int z) {
+    const BlockId block = source.get(x, y, z);
+    if (block == BLOCK_AIR) return 0;
+    if (source.isFaceHidden(face, x, y, z)) return 0;
+    return block;
+}
+
+// Greedy meshing over a grid of n cells per axis (n <= MaxN): visible
+// coplanar faces with the same attribute in each slice are merged into
+// maximal rectangles. attributeOf(face, x, y, z) is the cell's face attribute
+// (0 = hidden), solidAt(x, y, z) its occupancy for the ambient occlusion (see
+// quadOcclusion), corner(i) maps cell boundary i to chunk-local corner
+// coordinates. Count is int for LOD grids, full-resolution chunks pass a
+// std::integral_constant so the loops are compiled for their size.
+template <int MaxN, typename Count, typename AttributeFn, typename SolidFn, typename CornerFn>
+void greedyMesh(Count count, const AttributeFn& attributeOf, const SolidFn& solidAt, const CornerFn& corner,
+                std::vector<ChunkVertex>& vertices) {
+    const int n = count;
+    std::array<int, MaxN * MaxN> mask;
+
+    for (int face = 0; face < 6; face++) {
+        // Slice along the face normal, u and v span the slice
+        const int axis = face / 2;
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+
+        for (int slice = 0; slice < n; slice++) {
+            // Build the visibility mask for this slice
+            int pos[3];
+            pos[axis] = slice;
+            for (int j = 0; j < n; j++) {
+                for (int i = 0; i < n; i++) {
+                    pos[u] = i;
+                    pos[v] = j;
+                    mask[j * n + i] = attributeOf(face, pos[0], pos[1], pos[2]);
+                }
+            }
+
+            // Merge runs into rectangles: grow along u first, then along v
+            for (int j = 0; j < n; j++) {
+                for (int i = 0; i < n; ) {
+                    const int attribute = mask[j * n + i];
+                    if (attribute == 0) {
+                        i++;
+                        continue;
+                    }
+
+                    int width = 1;
+                    while (i + width < n && mask[j * n + i + width] == attribute) {
+                        width++;
+                    }
+
+                    int height = 1;
+                    for (; j + height < n; height++) {
+                        bool rowMatches = true;
+                        for (int k = 0; k < width; k++) {
+                            if (mask[(j + height) * n + i + k] != attribute) {
+                                rowMatches = false;
+                                break;
+                            }
+                        }
+                        if (!rowMatches) break;
+                    }
+
+                    // Consume the rectangle
+                    for (int h = 0; h < height; h++) {
+                        for (int k = 0; k < width; k++) {
+                            mask[(j + h) * n + i + k] = 0;
+                        }
+                    }
+
+                    // Occlusion in cells, the quad itself in voxels
+                    int cellMin[3];
+                    int cellSize[3];
+                    cellMin[axis] = slice;
+                    cellMin[u] = i;
+                    cellMin[v] = j;
+                    cellSize[axis] = 1;
+                    cellSize[u] = width;
+                    cellSize[v] = height;
+                    const unsigned int occlusion = quadOcclusion(solidAt, n, face, cellMin, cellSize);
+
+                    int minCorner[3];
+                    int size[3];
+                    for (int a = 0; a < 3; a++) {
+                        minCorner[a] = corner(cellMin[a]);
+                        size[a] = corner(cellMin[a] + cellSize[a]) - minCorner[a];
+                    }
+
+                    appendFace(vertices, face, minCorner[0], minCorner[1], minCorner[2],
+                               size[0], size[1], size[2], static_cast<BlockId>(attribute), occlusion);
+
+                    i += width;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+void appendFace(std::vector<ChunkVertex>& vertices, int face, int minX, int minY, int minZ,
+                int sizeX, int sizeY, int sizeZ, BlockId block, unsigned int occlusion) {
+    // Wider ids don't fit the packed vertex, they draw as the shader's unknown block
+    assert(block <= CHUNK_VERTEX_MAX_BLOCK && "block id doesn't fit the packed vertex");
+    const int packedBlock = std::min<int>(block, CHUNK_VERTEX_MAX_BLOCK);
+    for (int i = 0; i < 4; i++) {
+        const int* corner = faceCorners[face][i];
+        vertices.push_back(packChunkVertex(minX + corner[0] * sizeX, minY + corner[1] * sizeY, minZ + corner[2] * sizeZ,
+                                           face, (occlusion >> (2 * i)) & 3, packedBlock));
+    }
+}
+
+template <int Size>
+void buildCulledMesh(const BasicChunk<Size>& chunk, const BasicChunkNeighbours<Size>& neighbours,
+                     std::vector<ChunkVertex>& vertices) {
+    vertices.clear();
+
+    // Nothing to emit for an all-air chunk
+    if (chunk.blocks.isUniform() && chunk.blocks.uniformValue() == BLOCK_AIR) return;
+    const MeshSource<Size> source(chunk, neighbours);
+    auto solidAt = [&](int x, int y, int z) { return source.isSolidAt(x, y, z); };
+
+    for (int y = 0; y < Size; y++) {
+        for (int x = 0; x < Size; x++) {
+            for (int z = 0; z < Size; z++) {
+                const BlockId block = source.get(x, y, z);
+                if (block == BLOCK_AIR) continue;
+
+                for (int face = 0; face < 6; face++) {
+                    if (source.isFaceHidden(face, x, y, z)) continue;
+                    const int voxel[3] = {x, y, z};
+                    const int unit[3] = {1, 1, 1};
+                    const unsigned int occlusion = quadOcclusion(solidAt, Size, face, voxel, unit);
+                    appendFace(vertices, face, x, y, z, 1, 1, 1, block, occlusion);
+                }
+            }
+        }
+    }
+}
+
+template <int Size>
+void buildGreedyMesh(const BasicChunk<Size>& chunk, const BasicChunkNeighbours<Size>& neighbours,
+                     std::vector<ChunkVertex>& vertices) {
+    vertices.clear();
+
+    if (chunk.blocks.isUniform() && chunk.blocks.uniformValue() == BLOCK_AIR) return;
+    const MeshSource<Size> source(chunk, neighbours);
+
+    greedyMesh<Size>(std::integral_constant<int, Size>(),
+                     [&](int face, int x, int y, int z) { return faceAttribute(source, face, x, y, z); },
+                     [&](int x, int y, int z) { return source.isSolidAt(x, y, z); }, [](int i) { return i; }, vertices);
+}
+
+template <int Size>
+void buildBinaryGreedyMesh(const BasicChunk<Size>& chunk, const BasicChunkNeighbours<Size>& neighbours,
+                           std::vector<ChunkVertex>& vertices) {
+    using RowMask = typename BasicChunk<Size>::RowMask;
+    constexpr int AREA = BasicChunk<Size>::AREA;
+    constexpr int MASK_BITS = std::numeric_limits<RowMask>::digits;
+    constexpr RowMask FULL_ROW = Size == MASK_BITS ? ~RowMask(0) : (RowMask(1) << Size) - 1;
+    vertices.clear();
+
+    if (chunk.blocks.isUniform() && chunk.blocks.uniformValue() == BLOCK_AIR) return;
+
+    thread_local BinaryMeshScratch<Size> scratch;
+    std::vector<BlockId>& types = scratch.types;
+    std::vector<RowMask>& solid = scratch.solid;
+    chunk.blocks.usedBlocks(types);
+    types.erase(std::remove(types.begin(), types.end(), BLOCK_AIR), types.end());
+    scratch.voxels.resize((BasicChunk<Size>::VOLUME + 63) / 64);
+    solid.resize(3 * AREA);
+
+    // Faces only merge within a block type, so several types need their own
+    // columns. Any of them hides a face.
+    const int typeCount = static_cast<int>(types.size());
+    if (typeCount == 1) {
+        chunk.blocks.matchMask(types[0], scratch.voxels.data());
+        buildColumns<Size>(scratch.voxels.data(), solid.data());
+    } else {
+        scratch.typed.resize(static_cast<size_t>(typeCount) * 3 * AREA);
+        std::fill(solid.begin(), solid.end(), 0);
+        for (int type = 0; type < typeCount; type++) {
+            RowMask* columns = scratch.typed.data() + static_cast<size_t>(type) * 3 * AREA;
+            chunk.blocks.matchMask(types[type], scratch.voxels.data());
+            buildColumns<Size>(scratch.voxels.data(), columns);
+            for (int i = 0; i < 3 * AREA; i++) solid[i] |= columns[i];
+        }
+    }
+
+    // Occupancy for the ambient occlusion, the z columns inside the chunk
+    auto solidAt = [&](int x, int y, int z) {
+        const BasicChunk<Size>* target;
+        if (x < 0)          { target = neighbours[0]; x += Size; }
+        else if (x >= Size) { target = neighbours[1]; x -= Size; }
+        else if (y < 0)     { target = neighbours[2]; y += Size; }
+        else if (y >= Size) { target = neighbours[3]; y -= Size; }
+        else if (z < 0)     { target = neighbours[4]; z += Size; }
+        else if (z >= Size) { target = neighbours[5]; z -= Size; }
+        else return ((solid[2 * AREA + y * Size + x] >> z) & 1) != 0;
+
+        return target != nullptr && target->isSolid(x, y, z);
+    };
+
+    std::vector<RowMask>& planes = scratch.planes;
+    for (int face = 0; face < 6; face++) {
+        const int axis = face / 2;
+        const int u = (axis + 1) % 3;
+        const int v = (axis + 2) % 3;
+        const bool positive = (face & 1) != 0;
+        const BasicChunk<Size>* neighbour = neighbours[face];
+
+        // A voxel's face is hidden by the next voxel along the normal, the
+        // last one in the column by the neighbour's first layer. Visible faces
+        // are scattered into the slices' rows.
+        planes.assign(static_cast<size_t>(typeCount) * Size * Size, 0);
+        for (int j = 0; j < Size; j++) {
+            for (int i = 0; i < Size; i++) {
+                const RowMask column = solid[axis * AREA + j * Size + i];
+                if (column == 0) continue;
+
+                RowMask next = 0;
+                if (neighbour != nullptr) {
+                    int pos[3];
+                    pos[axis] = positive ? 0 : Size - 1;
+                    pos[u] = i;
+                    pos[v] = j;
+                    next = neighbour->isSolid(pos[0], pos[1], pos[2]) ? 1 : 0;
+                }
+                const RowMask covered = positive ? (column >> 1) | (next << (Size - 1))
+                                                 : ((column << 1) & FULL_ROW) | next;
+
+                for (int type = 0; type < typeCount; type++) {
+                    RowMask faces = typeCount > 1 ? scratch.typed[(static_cast<size_t>(type) * 3 + axis) * AREA + j * Size + i] : column;
+                    faces &= ~covered;
+                    for (; faces != 0; faces &= faces - 1) {
+                        const int slice = std::countr_zero(faces);
+                        planes[(static_cast<size_t>(type) * Size + slice) * Size + j] |= RowMask(1) << i;
+                    }
+                }
+            }
+        }
+
+        // Greedy merge of each slice, in greedyMesh's order: the run at the
+        // lowest set bit of a row, grown over the rows after it that contain it
+        for (int slice = 0; slice < Size; slice++) {
+            for (int type = 0; type < typeCount; type++) {
+                RowMask* rows = planes.data() + (static_cast<size_t>(type) * Size + slice) * Size;
+                for (int j = 0; j < Size; j++) {
+                    while (rows[j] != 0) {
+                        const int i = std::countr_zero(rows[j]);
+                        const int width = std::countr_one(static_cast<RowMask>(rows[j] >> i));
+                        const RowMask run = width == MASK_BITS ? ~RowMask(0) : ((RowMask(1) << width) - 1) << i;
+                        rows[j] &= ~run;
+
+                        int height = 1;
+                        for (; j + height < Size && (rows[j + height] & run) == run; height++) {
+                            rows[j + height] &= ~run;
+                        }
+
+                        int minCorner[3];
+                        int size[3];
+                        minCorner[axis] = slice;
+                        minCorner[u] = i;
+                        minCorner[v] = j;
+                        size[axis] = 1;
+                        size[u] = width;
+                        size[v] = height;
+                        appendFace(vertices, face, minCorner[0], minCorner[1], minCorner[2],
+                                   size[0], size[1], size[2], types[type],
+                                   quadOcclusion(solidAt, Size, face, minCorner, size));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void buildLodMesh(const Chunk& chunk, const ChunkNeighbours& neighbours, int lod, std::vector<ChunkVertex>& vertices) {
+    if (lod == 0) {
+        buildGreedyMesh(chunk, neighbours, vertices);
+        return;
+    }
+    vertices.clear();
+
+    if (chunk.blocks.isUniform() && chunk.blocks.uniformValue() == BLOCK_AIR) return;
+    const LodSource source(chunk, neighbours, lod);
+
+    // Cell boundaries in voxels, the last cell is clipped to the chunk
+    greedyMesh<CHUNK_SIZE>(source.n, [&](int face, int x, int y, int z) { return faceAttribute(source, face, x, y, z); },
+                           [&](int x, int y, int z) { return source.isSolidAt(x, y, z); },
+                           [lod](int i) { return std::min(i << lod, CHUNK_SIZE); }, vertices);
+}
+
+void downsampleChunk(const Chunk& chunk, int lod, std::vector<BlockId>& cells) {
+    const int n = lodCellCount(lod);
+    const int cellSize = 1 << lod;
+    if (chunk.blocks.isUniform()) {
+        cells.assign(n * n * n, chunk.blocks.uniformValue());
+        return;
+    }
+    cells.assign(n * n * n, BLOCK_AIR);
+
+    // Octree leaves are aligned to powers of two like the cells, so a leaf is
+    // either inside one cell or covers whole cells (clipped to the chunk)
+    std::vector<std::vector<std::pair<BlockId, int>>> volumes(cells.size()); // solid volume per block type
+    const SparseVoxelOctree octree = SparseVoxelOctree::fromChunk(chunk);
+    octree.forEachLeaf(glm::ivec3(0), glm::ivec3(CHUNK_SIZE), [&](const glm::ivec3& leafMin, int leafSize, BlockId block) {
+        if (block == BLOCK_AIR) return;
+
+        const glm::ivec3 leafMax = glm::min(leafMin + leafSize, glm::ivec3(CHUNK_SIZE));
+        const glm::ivec3 cellMin = leafMin / cellSize;
+        const glm::ivec3 cellMax = (leafMax + cellSize - 1) / cellSize;
+        for (int cy = cellMin.y; cy < cellMax.y; cy++) {
+            for (int cx = cellMin.x; cx < cellMax.x; cx++) {
+                for (int cz = cellMin.z; cz < cellMax.z; cz++) {
+                    const glm::ivec3 c(cx, cy, cz);
+                    const glm::ivec3 overlap = glm::min(leafMax, (c + 1) * cellSize) - glm::max(leafMin, c * cellSize);
+                    auto& cell = volumes[(cy * n + cx) * n + cz];
+                    auto entry = std::find_if(cell.begin(), cell.end(), [&](const auto& e) { return e.first == block; });
+                    if (entry == cell.end()) entry = cell.insert(cell.end(), {block, 0});
+                    entry->second += overlap.x * overlap.y * overlap.z;
+                }
+            }
+        }
+    });
+
+    // A cell is solid when at least half of it is, with its most common block
+    for (int cy = 0; cy < n; cy++) {
+        for (int cx = 0; cx < n; cx++) {
+            for (int cz = 0; cz < n; cz++) {
+                const int index = (cy * n + cx) * n + cz;
+                const glm::ivec3 c(cx, cy, cz);
+                const glm::ivec3 extent = glm::min((c + 1) * cellSize, glm::ivec3(CHUNK_SIZE)) - c * cellSize;
+
+                int solid = 0;
+                std::pair<BlockId, int> best(BLOCK_AIR, 0);
+                for (const auto& entry : volumes[index]) {
+                    solid += entry.second;
+                    if (entry.second > best.second) best = entry;
+                }
+                if (solid * 2 >= extent.x * extent.y * extent.z) cells[index] = best.first;
+            }
+        }
+    }
+}
+
+void buildOctreeInstances(const Chunk& chunk, std::vector<glm::vec4>& instances) {
+    instances.clear();
+
+    const SparseVoxelOctree octree = SparseVoxelOctree::fromChunk(chunk);
+    const glm::vec3 chunkMin(chunk.x, chunk.y, chunk.z);
+    octree.forEachLeaf(glm::ivec3(0), glm::ivec3(octree.getSize()), [&](const glm::ivec3& leafMin, int leafSize, BlockId block) {
+        if (block == BLOCK_AIR) return;
+
+        // Cubes are centered on their integer position
+        const glm::vec3 leafWorldMin = chunkMin + glm::vec3(leafMin) - 0.5f;
+        instances.emplace_back(leafWorldMin + leafSize * 0.5f, static_cast<float>(leafSize));
+    });
+}
+
+void findSolidLayers(const Chunk& chunk, int& begin, int& end) {
+    begin = end = 0;
+    if (chunk.blocks.isUniform()) {
+        if (chunk.blocks.uniformValue() != BLOCK_AIR) end = CHUNK_SIZE;
+        return;
+    }
+
+    // Runs on the mesh workers, a 64^3 chunk is too big for their stacks
+    thread_local std::vector<BlockId> blocks;
+    blocks.resize(CHUNK_VOLUME);
+    chunk.blocks.unpack(blocks.data());
+
+    // Each layer is one contiguous slab of the block array
+    int runStart = 0;
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        const BlockId* layer = blocks.data() + Chunk::index(0, y, 0);
+        bool solid = true;
+        for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE && solid; i++) {
+            solid = layer[i] != BLOCK_AIR;
+        }
+
+        if (!solid) {
+            runStart = y + 1;
+        } else if (y + 1 - runStart > end - begin) {
+            begin = runStart;
+            end = y + 1;
+        }
+    }
+}
+
+#define INSTANTIATE_MESHERS(size) \
+    template void buildCulledMesh<size>(const BasicChunk<size>&, const BasicChunkNeighbours<size>&, std::vector<ChunkVertex>&); \
+    template void buildGreedyMesh<size>(const BasicChunk<size>&, const BasicChunkNeighbours<size>&, std::vector<ChunkVertex>&); \
+    template void buildBinaryGreedyMesh<size>(const BasicChunk<size>&, const BasicChunkNeighbours<size>&, std::vector<ChunkVertex>&);
+FOR_EACH_CHUNK_SIZE(INSTANTIATE_MESHERS)
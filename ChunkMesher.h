@@ -0,0 +1,85 @@
+#ifndef CHUNKMESHER_H
+#define CHUNKMESHER_H
+
+#include <array>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+#include "ChunkVertex.h"
+
+// Neighbouring chunks in face order: -X, +X, -Y, +Y, -Z, +Z (nullptr = empty space)
+template <int Size>
+using BasicChunkNeighbours = std::array<const BasicChunk<Size>*, 6>;
+using ChunkNeighbours = BasicChunkNeighbours<CHUNK_SIZE>;
+
+// Emits only the faces of solid voxels that touch empty space, including across
+// chunk borders. Output is packed vertices (see ChunkVertex.h), 4 per face, in
+// the order the shared quad index buffer expects. Compiled for the sizes in
+// FOR_EACH_CHUNK_SIZE, like buildGreedyMesh.
+template <int Size>
+void buildCulledMesh(const BasicChunk<Size>& chunk, const BasicChunkNeighbours<Size>& neighbours,
+                     std::vector<ChunkVertex>& vertices);
+
+// Same visible faces as buildCulledMesh, but coplanar faces with the same
+// attributes in each slice are merged into maximal rectangles
+template <int Size>
+void buildGreedyMesh(const BasicChunk<Size>& chunk, const BasicChunkNeighbours<Size>& neighbours,
+                     std::vector<ChunkVertex>& vertices);
+
+// Same quads as buildGreedyMesh, in the same order for chunks with a single
+// solid block type, from bitmasks instead of per-voxel tests: every column of
+// the chunk is a RowMask per axis, visible faces come out of a shift and an
+// and-not against the column, and each slice is merged a row mask at a time
+// with bit scans.
+template <int Size>
+void buildBinaryGreedyMesh(const BasicChunk<Size>& chunk, const BasicChunkNeighbours<Size>& neighbours,
+                           std::vector<ChunkVertex>& vertices);
+
+// Coarsest level of detail: LOD l meshes cells of 2^l voxels per axis
+const int MAX_CHUNK_LOD = 3;
+
+// Cells per axis at a LOD, the last one is clipped to the chunk when
+// CHUNK_SIZE isn't a multiple of the cell size
+inline int lodCellCount(int lod) { return (CHUNK_SIZE + (1 << lod) - 1) >> lod; }
+
+// Downsample a chunk for a LOD from its sparse voxel octree. A cell is solid
+// when at least half of its voxels are, and takes the most common block.
+void downsampleChunk(const Chunk& chunk, int lod, std::vector<BlockId>& cells);
+
+// Greedy mesh of the chunk downsampled to a LOD (buildGreedyMesh at LOD 0).
+// Neighbours are downsampled to the same LOD for the border faces; pass
+// nullptr for neighbours drawn at another LOD, so both sides keep their
+// border faces and the seam between levels stays closed.
+void buildLodMesh(const Chunk& chunk, const ChunkNeighbours& neighbours, int lod, std::vector<ChunkVertex>& vertices);
+
+// Every non-empty leaf of the chunk's sparse voxel octree as a cube instance
+// (xyz = center, w = size), for drawing through CubeInstanceBuffer
+void buildOctreeInstances(const Chunk& chunk, std::vector<glm::vec4>& instances);
+
+// Longest run of fully solid y layers, [begin, end) in local coordinates
+// (begin == end if there is none). Used as the chunk's occluder.
+void findSolidLayers(const Chunk& chunk, int& begin, int& end);
+
+enum class MeshingMode {
+    Culled,
+    Greedy,
+    BinaryGreedy, // same mesh as Greedy, built from bitmasks
+    OctreeLeaves, // output goes to instances instead of vertices
+};
+
+// Append one face as a quad. min is the face's voxel min corner in
+// chunk-local corner coordinates, size the extent of the quad along each axis
+// (1 along the normal). occlusion holds the ambient occlusion of the four
+// corners, 2 bits each (0 = open), as the meshers compute it from the voxels
+// around the quad. Blocks above CHUNK_VERTEX_MAX_BLOCK assert.
+void appendFace(std::vector<ChunkVertex>& vertices, int face, int minX, int minY, int minZ,
+                int sizeX, int sizeY, int sizeZ, BlockId block, unsigned int occlusion = 0);
+
+// Number of quads in a mesh produced by the functions above
+inline size_t meshQuadCount(const std::vector<ChunkVertex>& vertices) { return vertices.size() / 4; }
+
+// Most quads a chunk mesh can have: one per pair of neighbouring voxels plus
+// the chunk border (a checkerboard comes close). Sizes the shared index buffer.
+const int MAX_CHUNK_QUADS = 3 * CHUNK_VOLUME + 3 * CHUNK_SIZE * CHUNK_SIZE;
+
+#endif //CHUNKMESHER_H
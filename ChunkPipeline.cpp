@@ -0,0 +1,142 @@
+#include "ChunkPipeline.h"
+#include <chrono>
+#include <cstring>
+#include "ChunkVisibility.h"
+#include "Profiler.h"
+#include "TerrainGenerator.h"
+
+namespace {
+    // Copy data into the ring if it has room, into the fallback vector otherwise
+    template <typename T>
+    void stage(UploadRing* ring, const std::vector<T>& data, UploadSpan& span, std::vector<T>& fallback) {
+        if (ring != nullptr) span = ring->reserve(data.size() * sizeof(T));
+        if (span.data != nullptr) {
+            std::memcpy(span.data, data.data(), span.size);
+        } else {
+            fallback = data;
+        }
+    }
+}
+
+ChunkPipeline::ChunkPipeline(JobSystem& jobs)
+    : jobs(jobs), uploadRing(nullptr) {}
+
+void ChunkPipeline::generate(const std::shared_ptr<Chunk>& chunk, int priority) {
+    jobs.submit([this, chunk] {
+        PROFILE_ZONE("Generate Chunk");
+        generateChunk(*chunk);
+        chunk->generated.store(true, std::memory_order_release);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        generated.push_back(chunk);
+    }, priority, cancelTokenOf(chunk));
+}
+
+void ChunkPipeline::mesh(const std::shared_ptr<Chunk>& chunk, const std::array<std::shared_ptr<Chunk>, 6>& neighbours,
+                         MeshingMode mode, int lod, int priority) {
+    const unsigned int version = chunk->meshVersion;
+    jobs.submit([this, chunk, neighbours, mode, lod, version] {
+        PROFILE_ZONE("Mesh Chunk");
+        ChunkNeighbours raw{};
+        for (int i = 0; i < 6; i++) {
+            raw[i] = neighbours[i].get();
+        }
+
+        // Meshes are built in per-worker scratch vectors that keep their capacity
+        thread_local std::vector<ChunkVertex> vertices;
+        thread_local std::vector<glm::vec4> instances;
+
+        MeshResult result{chunk, version, {}, {}, {}, mode == MeshingMode::OctreeLeaves, lod, 0, 0, 0};
+        if (lod > 0 && !result.instanced) {
+            buildLodMesh(*chunk, raw, lod, vertices);
+        } else {
+            switch (mode) {
+                case MeshingMode::Culled: buildCulledMesh(*chunk, raw, vertices); break;
+                case MeshingMode::Greedy: buildGreedyMesh(*chunk, raw, vertices); break;
+                case MeshingMode::BinaryGreedy: buildBinaryGreedyMesh(*chunk, raw, vertices); break;
+                case MeshingMode::OctreeLeaves: buildOctreeInstances(*chunk, instances); break;
+            }
+        }
+        if (result.instanced) {
+            stage(uploadRing, instances, result.span, result.instances);
+        } else {
+            stage(uploadRing, vertices, result.span, result.vertices);
+        }
+        // Downsampled meshes can have holes where the full resolution layers
+        // are solid, so only full resolution chunks occlude
+        if (lod == 0) findSolidLayers(*chunk, result.occluderBegin, result.occluderEnd);
+        result.faceConnections = computeFaceConnections(*chunk);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(std::move(result));
+    }, priority, cancelTokenOf(chunk));
+}
+
+std::vector<std::shared_ptr<Chunk>> ChunkPipeline::takeGenerated() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::shared_ptr<Chunk>> done;
+    done.swap(generated);
+    return done;
+}
+
+int ChunkPipeline::uploadReady(double budgetMs, ChunkRenderPool& renderPool) {
+    PROFILE_ZONE("Mesh Uploads");
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    int uploaded = 0;
+    while (true) {
+        MeshResult result;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (ready.empty()) break;
+            result = std::move(ready.front());
+            ready.pop_front();
+        }
+
+        // Drop results for unloaded chunks and meshes that were superseded
+        Chunk& chunk = *result.chunk;
+        if (chunk.cancelled.load() || result.version != chunk.meshVersion) {
+            if (uploadRing != nullptr) uploadRing->release(result.span);
+            continue;
+        }
+
+        ChunkRenderData& render = renderPool[chunk.renderSlot];
+
+        // Mesh positions are relative to the chunk's min corner, cubes are centered on integer positions
+        const glm::vec3 origin = glm::vec3(chunk.x, chunk.y, chunk.z) - 0.5f;
+        if (result.span.data != nullptr) {
+            if (result.instanced) {
+                render.instances.upload(*uploadRing, result.span);
+            } else {
+                render.mesh.upload(*uploadRing, result.span, origin);
+            }
+        } else if (result.instanced) {
+            render.instances.assign(std::move(result.instances));
+            render.instances.upload();
+        } else {
+            render.mesh.upload(result.vertices, origin);
+        }
+        chunk.meshLod = result.lod;
+        chunk.occluderBegin = result.occluderBegin;
+        chunk.occluderEnd = result.occluderEnd;
+        chunk.faceConnections = result.faceConnections;
+        uploaded++;
+
+        const double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (elapsedMs >= budgetMs) break;
+    }
+
+    if (uploadRing != nullptr) uploadRing->endFrame();
+    return uploaded;
+}
+
+int ChunkPipeline::readyCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int>(ready.size());
+}
+
+CancelToken ChunkPipeline::cancelTokenOf(const std::shared_ptr<Chunk>& chunk) {
+    // Shares ownership with the chunk, pointing at its cancelled flag
+    return CancelToken(chunk, &chunk->cancelled);
+}
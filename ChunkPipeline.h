@@ -0,0 +1,68 @@
+#ifndef CHUNKPIPELINE_H
+#define CHUNKPIPELINE_H
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+#include "ChunkMesher.h"
+#include "ChunkRenderPool.h"
+#include "JobSystem.h"
+#include "UploadRing.h"
+
+// Chunk work split across threads: generate -> mesh run as jobs on the
+// JobSystem and produce CPU-side data only; the render thread picks the
+// finished meshes up with uploadReady() and does the GL uploads under a
+// time budget. With an upload ring set, workers copy finished meshes into it
+// and the uploads are GPU side copies.
+class ChunkPipeline {
+public:
+    explicit ChunkPipeline(JobSystem& jobs);
+
+    // Set before the first mesh job, nullptr uploads from CPU vectors
+    void setUploadRing(UploadRing* ring) { uploadRing = ring; }
+
+    // Worker side: fill the chunk's blocks, then report it through takeGenerated()
+    void generate(const std::shared_ptr<Chunk>& chunk, int priority);
+
+    // Worker side: build the chunk's mesh against its (generated) neighbours,
+    // at a level of detail above 0 with buildLodMesh (Culled and Greedy modes)
+    void mesh(const std::shared_ptr<Chunk>& chunk, const std::array<std::shared_ptr<Chunk>, 6>& neighbours,
+              MeshingMode mode, int lod, int priority);
+
+    // Render thread: chunks whose generation finished since the last call
+    std::vector<std::shared_ptr<Chunk>> takeGenerated();
+
+    // Render thread: upload finished meshes into the chunks' slots of renderPool
+    // until budgetMs is spent, returns the number uploaded
+    int uploadReady(double budgetMs, ChunkRenderPool& renderPool);
+
+    int readyCount() const;
+
+private:
+    struct MeshResult {
+        std::shared_ptr<Chunk> chunk;
+        unsigned int version;
+        std::vector<ChunkVertex> vertices;
+        std::vector<glm::vec4> instances;
+        UploadSpan span; // holds the vertices or instances instead when reserved
+        bool instanced;
+        int lod;
+        int occluderBegin, occluderEnd;
+        uint64_t faceConnections;
+    };
+
+    static CancelToken cancelTokenOf(const std::shared_ptr<Chunk>& chunk);
+
+    JobSystem& jobs;
+    UploadRing* uploadRing;
+
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<Chunk>> generated;
+    std::deque<MeshResult> ready;
+};
+
+#endif //CHUNKPIPELINE_H
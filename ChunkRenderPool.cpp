@@ -0,0 +1,28 @@
+#include "ChunkRenderPool.h"
+
+int ChunkRenderPool::acquire() {
+    if (!freeSlots.empty()) {
+        const int slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    slots.emplace_back();
+    return static_cast<int>(slots.size()) - 1;
+}
+
+void ChunkRenderPool::release(int slot) {
+    ChunkRenderData& data = slots[slot];
+    data.mesh.cleanup();
+    data.instances.cleanup();
+    data.instances.clear();
+    freeSlots.push_back(slot);
+}
+
+void ChunkRenderPool::clear() {
+    for (ChunkRenderData& data : slots) {
+        data.mesh.cleanup();
+        data.instances.cleanup();
+    }
+    slots.clear();
+    freeSlots.clear();
+}
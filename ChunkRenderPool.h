@@ -0,0 +1,34 @@
+#ifndef CHUNKRENDERPOOL_H
+#define CHUNKRENDERPOOL_H
+
+#include <deque>
+#include <vector>
+#include "CubeInstanceBuffer.h"
+#include "ChunkMesh.h"
+
+// GPU side of a resident chunk. Kept out of Chunk so the voxel data, and the
+// kernels and benchmarks built on it, don't depend on GL.
+struct ChunkRenderData {
+    CubeInstanceBuffer instances; // visible cubes, drawn in one instanced call
+    ChunkMesh mesh;               // face-culled surface of the whole chunk
+};
+
+// Render data of the world's chunks, indexed by Chunk::renderSlot. Released
+// slots are reused; a deque so handing out a new one never moves the others.
+// Render thread only.
+class ChunkRenderPool {
+public:
+    int acquire();
+    // Frees the slot's GL resources
+    void release(int slot);
+    void clear();
+
+    ChunkRenderData& operator[](int slot) { return slots[slot]; }
+    const ChunkRenderData& operator[](int slot) const { return slots[slot]; }
+
+private:
+    std::deque<ChunkRenderData> slots;
+    std::vector<int> freeSlots;
+};
+
+#endif //CHUNKRENDERPOOL_H
@@ -0,0 +1,21 @@
+#ifndef CHUNKVERTEX_H
+#define CHUNKVERTEX_H
+
+#include <cstdint>
+
+// Packed chunk mesh vertex (4 bytes), decoded in vertex_shader.glsl:
+//   bits  0-20  corner position relative to the chunk's min corner, 7 bits per axis
+//   bits 21-23  face, -X +X -Y +Y -Z +Z (the normal)
+//   bits 24-25  ambient occlusion of the corner, 0 (open) to 3 (in a crease)
+//   bits 26-31  block id, picks the color in fragment_shader.glsl
+using ChunkVertex = uint32_t;
+const int CHUNK_VERTEX_MAX_COORD = 127;
+const int CHUNK_VERTEX_MAX_BLOCK = 63; // wider ids need a wider vertex, appendFace checks
+
+inline ChunkVertex packChunkVertex(int x, int y, int z, int face, int occlusion, int block) {
+    return static_cast<ChunkVertex>(x) | static_cast<ChunkVertex>(y) << 7 | static_cast<ChunkVertex>(z) << 14 |
+           static_cast<ChunkVertex>(face) << 21 | static_cast<ChunkVertex>(occlusion) << 24 |
+           static_cast<ChunkVertex>(block) << 26;
+}
+
+#endif //CHUNKVERTEX_H
@@ -0,0 +1,135 @@
+#include "ChunkVisibility.h"
+#include <deque>
+
+namespace {
+
+const glm::ivec3 faceOffsets[6] = {
+    {-1, 0, 0}, {1, 0, 0},
+    {0, -1, 0}, {0, 1, 0},
+    {0, 0, -1}, {0, 0, 1},
+};
+
+int oppositeFace(int face) {
+    return face ^ 1;
+}
+
+// Faces of the chunk a voxel lies on, as a 6-bit mask
+unsigned int borderFaces(int x, int y, int z) {
+    unsigned int faces = 0;
+    if (x == 0) faces |= 1u << 0;
+    if (x == CHUNK_SIZE - 1) faces |= 1u << 1;
+    if (y == 0) faces |= 1u << 2;
+    if (y == CHUNK_SIZE - 1) faces |= 1u << 3;
+    if (z == 0) faces |= 1u << 4;
+    if (z == CHUNK_SIZE - 1) faces |= 1u << 5;
+    return faces;
+}
+
+FaceConnections connectAll(unsigned int faces) {
+    FaceConnections connections = 0;
+    for (int a = 0; a < 6; a++) {
+        if (!(faces & (1u << a))) continue;
+        for (int b = 0; b < 6; b++) {
+            if (faces & (1u << b)) connections |= FaceConnections(1) << (a * 6 + b);
+        }
+    }
+    return connections;
+}
+
+}
+
+FaceConnections computeFaceConnections(const Chunk& chunk) {
+    if (chunk.blocks.isUniform()) {
+        return chunk.blocks.uniformValue() == BLOCK_AIR ? connectAll(0x3F) : 0;
+    }
+
+    // Runs on the mesh workers, a 64^3 chunk is too big for their stacks
+    thread_local std::vector<BlockId> blocks;
+    thread_local std::vector<char> visited;
+    blocks.resize(CHUNK_VOLUME);
+    visited.resize(CHUNK_VOLUME);
+    chunk.blocks.unpack(blocks.data());
+
+    // Solid voxels start out visited so the fill only walks air
+    for (int i = 0; i < CHUNK_VOLUME; i++) {
+        visited[i] = blocks[i] != BLOCK_AIR;
+    }
+
+    FaceConnections connections = 0;
+    std::vector<int> stack;
+    for (int y = 0; y < CHUNK_SIZE; y++) {
+        for (int x = 0; x < CHUNK_SIZE; x++) {
+            for (int z = 0; z < CHUNK_SIZE; z++) {
+                // Regions that don't touch the border can't connect anything,
+                // so only start fills from border voxels
+                if (borderFaces(x, y, z) == 0 || visited[Chunk::index(x, y, z)]) continue;
+
+                unsigned int touched = 0;
+                stack.push_back(Chunk::index(x, y, z));
+                visited[stack.back()] = true;
+                while (!stack.empty()) {
+                    const int index = stack.back();
+                    stack.pop_back();
+                    // index = (y * CHUNK_SIZE + x) * CHUNK_SIZE + z
+                    const int vz = index % CHUNK_SIZE;
+                    const int vx = (index / CHUNK_SIZE) % CHUNK_SIZE;
+                    const int vy = index / (CHUNK_SIZE * CHUNK_SIZE);
+                    touched |= borderFaces(vx, vy, vz);
+
+                    for (const glm::ivec3& offset : faceOffsets) {
+                        const int nx = vx + offset.x, ny = vy + offset.y, nz = vz + offset.z;
+                        if (nx < 0 || ny < 0 || nz < 0 || nx >= CHUNK_SIZE || ny >= CHUNK_SIZE || nz >= CHUNK_SIZE) continue;
+                        const int next = Chunk::index(nx, ny, nz);
+                        if (visited[next]) continue;
+                        visited[next] = true;
+                        stack.push_back(next);
+                    }
+                }
+                connections |= connectAll(touched);
+            }
+        }
+    }
+    return connections;
+}
+
+void findReachableChunks(const ChunkMap& chunks, const glm::ivec3& start, const Frustum& frustum,
+                         unsigned int stamp, std::vector<Chunk*>& reachable) {
+    struct Step {
+        glm::ivec3 coord;
+        Chunk* chunk;
+        int entryFace;       // face of this chunk the walk came in through, -1 for the start
+        unsigned int taken;  // directions taken so far, 6-bit mask
+    };
+
+    Chunk* first = chunks.find(start);
+    if (first == nullptr) return;
+
+    std::deque<Step> queue;
+    first->visibilityStamp = stamp;
+    queue.push_back({start, first, -1, 0});
+
+    while (!queue.empty()) {
+        const Step step = queue.front();
+        queue.pop_front();
+
+        const bool generated = step.chunk->generated.load(std::memory_order_acquire);
+        if (generated) reachable.push_back(step.chunk);
+
+        for (int face = 0; face < 6; face++) {
+            // Going back the way we came can't reveal anything new
+            if (step.taken & (1u << oppositeFace(face))) continue;
+            if (step.entryFace >= 0 && generated && !facesConnected(step.chunk->faceConnections, step.entryFace, face)) continue;
+
+            const glm::ivec3 coord = step.coord + faceOffsets[face];
+            Chunk* next = chunks.find(coord);
+            if (next == nullptr || next->visibilityStamp == stamp) continue;
+
+            // Cubes are centered on integer positions
+            glm::vec3 origin(next->x, next->y, next->z);
+            if (!frustum.isAABBInFrustum(origin - 0.5f, origin + (CHUNK_SIZE - 0.5f))) continue;
+
+            next->visibilityStamp = stamp;
+            queue.push_back({coord, next, oppositeFace(face), step.taken | (1u << face)});
+        }
+    }
+}
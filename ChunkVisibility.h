@@ -0,0 +1,31 @@
+#ifndef CHUNKVISIBILITY_H
+#define CHUNKVISIBILITY_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+#include "ChunkMap.h"
+#include "Frustum.h"
+
+// Which faces of a chunk can see each other through air, as a 6x6 matrix over
+// the faces in ChunkNeighbours order (-X, +X, -Y, +Y, -Z, +Z): bit a * 6 + b.
+using FaceConnections = uint64_t;
+
+inline bool facesConnected(FaceConnections connections, int a, int b) {
+    return (connections >> (a * 6 + b)) & 1;
+}
+
+// Flood fills the chunk's air and connects every pair of faces each air region touches
+FaceConnections computeFaceConnections(const Chunk& chunk);
+
+// Breadth-first walk from the camera's chunk. A chunk is entered through one
+// face and left through another only if the two are connected, never in the
+// direction opposite to one already taken on the way there, and only into
+// chunks inside the frustum. Chunks that are not generated yet count as open.
+// The generated chunks that were reached go to reachable. stamp must differ
+// from the one used on the previous call.
+void findReachableChunks(const ChunkMap& chunks, const glm::ivec3& start, const Frustum& frustum,
+                         unsigned int stamp, std::vector<Chunk*>& reachable);
+
+#endif //CHUNKVISIBILITY_H
@@ -0,0 +1,322 @@
+#include "ClipmapTerrain.h"
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cmath>
+#include "ChunkMesher.h"
+#include "Profiler.h"
+#include "TerrainGenerator.h"
+
+namespace {
+
+int floorDiv(int a, int b) {
+    return (a >= 0 ? a : a - b + 1) / b;
+}
+
+glm::ivec2 floorDiv(const glm::ivec2& a, int b) {
+    return glm::ivec2(floorDiv(a.x, b), floorDiv(a.y, b));
+}
+
+int wrap(int a, int n) {
+    return ((a % n) + n) % n;
+}
+
+// Rects are [x0, z0, x1, z1), empty ones are all zero so they compare equal
+glm::ivec4 intersect(const glm::ivec4& a, const glm::ivec4& b) {
+    const glm::ivec4 r(std::max(a.x, b.x), std::max(a.y, b.y), std::min(a.z, b.z), std::min(a.w, b.w));
+    return r.x < r.z && r.y < r.w ? r : glm::ivec4(0);
+}
+
+bool overlaps(const glm::ivec4& a, const glm::ivec4& b) {
+    return a.x < b.z && b.x < a.z && a.y < b.w && b.y < a.w;
+}
+
+bool contains(const glm::ivec4& r, int x, int z) {
+    return x >= r.x && x < r.z && z >= r.y && z < r.w;
+}
+
+// Side faces of a column, the neighbour each one looks at
+const int sideFaces[4] = {0, 1, 4, 5}; // -X, +X, -Z, +Z
+const int sideOffsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+const int FACE_TOP = 3; // +Y
+
+} // namespace
+
+ClipmapTerrain::ClipmapTerrain(int levelCount, int baseVoxelSize)
+    : holeCenter(0), holeRadius(-1), holeVertical(0), holeVersion(0), sampled(0), remeshed(0), triangles(0) {
+    levels.resize(levelCount);
+    for (int l = 0; l < levelCount; l++) {
+        levels[l].voxelSize = baseVoxelSize << l;
+        levels[l].heights.resize(SIZE * SIZE);
+        levels[l].tiles.resize(TILE_SLOTS * TILE_SLOTS);
+    }
+}
+
+void ClipmapTerrain::update(const glm::vec3& cameraPos, const glm::ivec3& center, int radius, int vertical) {
+    PROFILE_ZONE("Far Terrain Update");
+    sampled = 0;
+    remeshed = 0;
+    if (center != holeCenter || radius != holeRadius || vertical != holeVertical) {
+        holeCenter = center;
+        holeRadius = radius;
+        holeVertical = vertical;
+        holeVersion++;
+    }
+    // Voxels the chunk hole can reach, horizontally
+    const glm::ivec4 holeBounds((holeCenter.x - holeRadius) * CHUNK_SIZE, (holeCenter.z - holeRadius) * CHUNK_SIZE,
+                                (holeCenter.x + holeRadius + 1) * CHUNK_SIZE, (holeCenter.z + holeRadius + 1) * CHUNK_SIZE);
+
+    const glm::ivec2 cameraVoxel(static_cast<int>(std::floor(cameraPos.x + 0.5f)),
+                                 static_cast<int>(std::floor(cameraPos.z + 0.5f)));
+
+    for (int l = 0; l < levelCount(); l++) {
+        Level& level = levels[l];
+        const int s = level.voxelSize;
+
+        // Keep the origin even so the window lines up with the next level's columns
+        slideWindow(level, floorDiv(floorDiv(cameraVoxel, s) - SIZE / 2, 2) * 2);
+        const glm::ivec4 window(level.origin, level.origin + SIZE);
+        const glm::ivec4 finerHole = finerWindow(l);
+
+        std::array<bool, TILE_SLOTS * TILE_SLOTS> touched{};
+        const glm::ivec2 firstTile = floorDiv(level.origin, TILE);
+        const glm::ivec2 lastTile = floorDiv(level.origin + SIZE - 1, TILE);
+        for (int kz = firstTile.y; kz <= lastTile.y; kz++) {
+            for (int kx = firstTile.x; kx <= lastTile.x; kx++) {
+                const int slot = wrap(kz, TILE_SLOTS) * TILE_SLOTS + wrap(kx, TILE_SLOTS);
+                Tile& tile = level.tiles[slot];
+                touched[slot] = true;
+
+                // Walls look one column past the tile, so changes there matter too
+                const glm::ivec4 rect(kx * TILE, kz * TILE, (kx + 1) * TILE, (kz + 1) * TILE);
+                const glm::ivec4 grown = rect + glm::ivec4(-1, -1, 1, 1);
+                const glm::ivec4 clip = intersect(rect, window);
+                const glm::ivec4 grownWindow = intersect(grown, window);
+                const glm::ivec4 hole = intersect(grown, finerHole);
+                const bool touchesHole = holeRadius >= 0 && overlaps(grown * s, holeBounds);
+
+                bool resampled = false;
+                for (const glm::ivec4& sampledRect : level.sampledRects) {
+                    resampled = resampled || overlaps(grown, sampledRect);
+                }
+
+                const bool dirty = !tile.active || tile.coord != glm::ivec2(kx, kz) || tile.window != grownWindow ||
+                                   tile.finerHole != hole || resampled ||
+                                   ((touchesHole || tile.touchesHole) && tile.holeVersion != holeVersion);
+                if (!dirty) continue;
+
+                tile.active = true;
+                tile.coord = glm::ivec2(kx, kz);
+                tile.clip = clip;
+                tile.window = grownWindow;
+                tile.finerHole = hole;
+                tile.touchesHole = touchesHole;
+                tile.holeVersion = holeVersion;
+                meshTile(level, finerHole, tile);
+                remeshed++;
+            }
+        }
+
+        // Slots the window moved off
+        for (int slot = 0; slot < TILE_SLOTS * TILE_SLOTS; slot++) {
+            Tile& tile = level.tiles[slot];
+            if (!touched[slot] && tile.active) {
+                tile.mesh.cleanup();
+                tile.active = false;
+            }
+        }
+    }
+}
+
+int ClipmapTerrain::queueVisible(const Frustum& frustum) {
+    tileBounds.clear();
+    boundsTiles.clear();
+    for (Level& level : levels) {
+        for (Tile& tile : level.tiles) {
+            if (!tile.active || tile.mesh.triangleCount() == 0) continue;
+            tileBounds.add(tile.boundsMin, tile.boundsMax);
+            boundsTiles.push_back(&tile);
+        }
+    }
+
+    frustum.cullAABBIndices(tileBounds, visibleTiles);
+    triangles = 0;
+    for (uint32_t index : visibleTiles) {
+        boundsTiles[index]->mesh.queueDraw();
+        triangles += boundsTiles[index]->mesh.triangleCount();
+    }
+    return static_cast<int>(visibleTiles.size());
+}
+
+void ClipmapTerrain::cleanup() {
+    for (Level& level : levels) {
+        for (Tile& tile : level.tiles) {
+            tile.mesh.cleanup();
+            tile.active = false;
+        }
+        level.valid = false;
+    }
+}
+
+float ClipmapTerrain::reach() const {
+    return levels.empty() ? 0.0f : static_cast<float>(levels.back().voxelSize * SIZE / 2);
+}
+
+size_t ClipmapTerrain::memoryUsage() const {
+    size_t bytes = 0;
+    for (const Level& level : levels) {
+        bytes += level.heights.size() * sizeof(int);
+        for (const Tile& tile : level.tiles) {
+            bytes += static_cast<size_t>(tile.mesh.triangleCount()) * 2 * sizeof(ChunkVertex); // 4 vertices per 2 triangles
+        }
+    }
+    return bytes;
+}
+
+void ClipmapTerrain::slideWindow(Level& level, const glm::ivec2& origin) {
+    level.sampledRects.clear();
+    if (level.valid && origin == level.origin) return;
+
+    const glm::ivec2 shift = origin - level.origin;
+    const bool resetAll = !level.valid || std::abs(shift.x) >= SIZE || std::abs(shift.y) >= SIZE;
+    level.origin = origin;
+    level.valid = true;
+    if (resetAll) {
+        sampleRect(level, glm::ivec4(origin, origin + SIZE));
+        return;
+    }
+
+    // Columns that came into view along x, over the whole window along z
+    int x0 = origin.x;
+    int x1 = origin.x + SIZE;
+    if (shift.x > 0) {
+        sampleRect(level, glm::ivec4(x1 - shift.x, origin.y, x1, origin.y + SIZE));
+        x1 -= shift.x;
+    } else if (shift.x < 0) {
+        sampleRect(level, glm::ivec4(x0, origin.y, x0 - shift.x, origin.y + SIZE));
+        x0 -= shift.x;
+    }
+
+    // Then the rows along z, minus the columns just sampled
+    if (shift.y > 0) {
+        sampleRect(level, glm::ivec4(x0, origin.y + SIZE - shift.y, x1, origin.y + SIZE));
+    } else if (shift.y < 0) {
+        sampleRect(level, glm::ivec4(x0, origin.y, x1, origin.y - shift.y));
+    }
+}
+
+void ClipmapTerrain::sampleRect(Level& level, const glm::ivec4& rect) {
+    if (rect.x >= rect.z || rect.y >= rect.w) return;
+    level.sampledRects.push_back(rect);
+
+    // One sample in the middle of each column, quantized to the voxel size
+    const int s = level.voxelSize;
+    for (int z = rect.y; z < rect.w; z++) {
+        for (int x = rect.x; x < rect.z; x++) {
+            heightAt(level, x, z) = floorDiv(terrainHeight(x * s + s / 2, z * s + s / 2), s);
+        }
+    }
+    sampled += (rect.z - rect.x) * (rect.w - rect.y);
+}
+
+void ClipmapTerrain::meshTile(const Level& level, const glm::ivec4& finerHole, Tile& tile) {
+    const int s = level.voxelSize;
+    const glm::ivec4& clip = tile.clip;
+
+    // Every face of the tile as (face, column, bottom, top), y in cell corners.
+    // A column has its top face and walls down to lower neighbours or, where
+    // the neighbour isn't drawn, a skirt closing the gap to the finer level,
+    // the chunks or the coarser level.
+    auto forEachFace = [&](auto&& emit) {
+        for (int z = clip.y; z < clip.w; z++) {
+            for (int x = clip.x; x < clip.z; x++) {
+                if (!isDrawn(level, finerHole, x, z)) continue;
+                const int top = heightAt(level, x, z) + 1;
+                emit(FACE_TOP, x, z, top - 1, top);
+
+                for (int i = 0; i < 4; i++) {
+                    const int nx = x + sideOffsets[i][0];
+                    const int nz = z + sideOffsets[i][1];
+                    if (isDrawn(level, finerHole, nx, nz)) {
+                        const int neighbourTop = heightAt(level, nx, nz) + 1;
+                        if (neighbourTop < top) emit(sideFaces[i], x, z, neighbourTop, top);
+                    } else {
+                        emit(sideFaces[i], x, z, top - SKIRT, top);
+                    }
+                }
+            }
+        }
+    };
+
+    int minY = INT_MAX;
+    int maxY = INT_MIN;
+    forEachFace([&](int, int, int, int bottom, int top) {
+        minY = std::min(minY, bottom);
+        maxY = std::max(maxY, top);
+    });
+    if (minY > maxY) {
+        tile.mesh.cleanup();
+        return;
+    }
+    // Packed vertices have 7 bits per axis, flatten anything taller (never
+    // happens with terrainHeight's range)
+    maxY = std::min(maxY, minY + 127);
+
+    const glm::ivec2 tileMin = tile.coord * TILE;
+    vertices.clear();
+    forEachFace([&](int face, int x, int z, int bottom, int top) {
+        bottom = std::min(bottom, maxY) - minY;
+        top = std::min(top, maxY) - minY;
+        const int lx = x - tileMin.x;
+        const int lz = z - tileMin.y;
+        if (face == FACE_TOP) {
+            appendFace(vertices, face, lx, bottom, lz, 1, 1, 1, BLOCK_STONE);
+        } else if (top > bottom) {
+            appendFace(vertices, face, lx, bottom, lz, 1, top - bottom, 1, BLOCK_STONE);
+        }
+    });
+
+    // Columns are centered on their voxels like the chunks' cubes
+    const glm::vec3 origin = glm::vec3(tileMin.x, minY, tileMin.y) * static_cast<float>(s) - 0.5f;
+    tile.mesh.upload(vertices, origin, static_cast<float>(s));
+    tile.boundsMin = glm::vec3(clip.x * s, minY * s, clip.y * s) - 0.5f;
+    tile.boundsMax = glm::vec3(clip.z * s, maxY * s, clip.w * s) - 0.5f;
+}
+
+int& ClipmapTerrain::heightAt(Level& level, int x, int z) {
+    return level.heights[wrap(z, SIZE) * SIZE + wrap(x, SIZE)];
+}
+
+int ClipmapTerrain::heightAt(const Level& level, int x, int z) const {
+    return level.heights[wrap(z, SIZE) * SIZE + wrap(x, SIZE)];
+}
+
+bool ClipmapTerrain::isDrawn(const Level& level, const glm::ivec4& finerHole, int x, int z) const {
+    if (!contains(glm::ivec4(level.origin, level.origin + SIZE), x, z) || contains(finerHole, x, z)) return false;
+    return !inChunkHole(level.voxelSize, x, z, heightAt(level, x, z));
+}
+
+bool ClipmapTerrain::inChunkHole(int voxelSize, int x, int z, int top) const {
+    if (holeRadius < 0) return false;
+
+    // The chunk holding the column's surface must be loaded...
+    const int chunkY = floorDiv(top * voxelSize, CHUNK_SIZE);
+    if (std::abs(chunkY - holeCenter.y) > holeVertical) return false;
+
+    // ...and so must every chunk the column overlaps. The loaded disc is
+    // convex, so checking the corner chunks is enough.
+    const int x0 = floorDiv(x * voxelSize, CHUNK_SIZE) - holeCenter.x;
+    const int x1 = floorDiv(x * voxelSize + voxelSize - 1, CHUNK_SIZE) - holeCenter.x;
+    const int z0 = floorDiv(z * voxelSize, CHUNK_SIZE) - holeCenter.z;
+    const int z1 = floorDiv(z * voxelSize + voxelSize - 1, CHUNK_SIZE) - holeCenter.z;
+    const int r2 = holeRadius * holeRadius;
+    return x0 * x0 + z0 * z0 <= r2 && x1 * x1 + z0 * z0 <= r2 && x0 * x0 + z1 * z1 <= r2 && x1 * x1 + z1 * z1 <= r2;
+}
+
+glm::ivec4 ClipmapTerrain::finerWindow(int levelIndex) const {
+    if (levelIndex == 0) return glm::ivec4(0);
+    // The finer origin is even, so this is exact
+    const glm::ivec2 origin = levels[levelIndex - 1].origin / 2;
+    return glm::ivec4(origin, origin + SIZE / 2);
+}
@@ -0,0 +1,101 @@
+#ifndef CLIPMAPTERRAIN_H
+#define CLIPMAPTERRAIN_H
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "ChunkMesh.h"
+#include "Frustum.h"
+
+// Far terrain past the loaded chunks, as a nested clipmap of terrainHeight
+// columns centered on the camera. Level l has SIZE x SIZE columns of
+// baseVoxelSize << l voxels each, so every level reaches twice as far as the
+// one before. A level leaves out the columns the finer level covers, and no
+// level draws the columns the loaded chunks already cover.
+//
+// Each level keeps its heights in a fixed SIZE x SIZE toroidal array: when the
+// window slides with the camera only the newly exposed rows and columns are
+// sampled. Meshes are kept per TILE x TILE tile, in toroidal slots as well,
+// and a tile is only remeshed when its heights or its clip against the window
+// and the holes change. Memory depends on the level count alone, not on how
+// far the terrain reaches, and the work per update on how far the camera moved.
+class ClipmapTerrain {
+public:
+    static const int SIZE = 64; // columns per level and axis, even
+    static const int TILE = 16; // columns per tile and axis, divides SIZE
+    static const int TILE_SLOTS = SIZE / TILE + 1; // tiles a window can touch per axis
+    static const int SKIRT = 2; // depth in columns of the walls closing level and hole borders
+
+    ClipmapTerrain(int levels, int baseVoxelSize);
+
+    ClipmapTerrain(const ClipmapTerrain&) = delete;
+    ClipmapTerrain& operator=(const ClipmapTerrain&) = delete;
+
+    // Slide the windows to the camera. Columns whose surface lies in a chunk
+    // World keeps loaded (within holeRadius chunks horizontally and
+    // holeVertical vertically of holeCenter) are left out.
+    void update(const glm::vec3& cameraPos, const glm::ivec3& holeCenter, int holeRadius, int holeVertical);
+
+    // Queue the tiles inside the frustum on the shared mesh pool (drawn by
+    // ChunkMesh::drawQueued), returns the number of tiles queued
+    int queueVisible(const Frustum& frustum);
+
+    // Release the tile meshes
+    void cleanup();
+
+    int levelCount() const { return static_cast<int>(levels.size()); }
+    float reach() const; // distance from the camera to the edge of the coarsest level
+
+    // Stats
+    int columnsSampled() const { return sampled; }   // last update
+    int tilesRemeshed() const { return remeshed; }   // last update
+    int trianglesQueued() const { return triangles; } // last queueVisible
+    size_t memoryUsage() const;
+
+private:
+    struct Tile {
+        bool active = false;       // inside the window this update
+        glm::ivec2 coord;          // in tiles of the level
+        glm::ivec4 clip;           // columns drawn [x0, z0, x1, z1) before the holes
+        glm::ivec4 window;         // level window clipped to the tile plus the one column its walls look at
+        glm::ivec4 finerHole;      // finer level's window clipped to the same grown tile
+        bool touchesHole = false;  // grown tile overlaps the chunk hole's bounds
+        unsigned int holeVersion = 0; // chunk hole version the mesh was built against
+        glm::vec3 boundsMin, boundsMax;
+        ChunkMesh mesh;
+    };
+
+    struct Level {
+        int voxelSize;
+        bool valid = false;
+        glm::ivec2 origin;         // first column of the window
+        std::vector<int> heights;  // top cell of each column (in voxelSize units), toroidal
+        std::vector<Tile> tiles;   // TILE_SLOTS x TILE_SLOTS, toroidal
+        std::vector<glm::ivec4> sampledRects; // resampled this update
+    };
+
+    void slideWindow(Level& level, const glm::ivec2& origin);
+    void sampleRect(Level& level, const glm::ivec4& rect);
+    void meshTile(const Level& level, const glm::ivec4& finerHole, Tile& tile);
+
+    int& heightAt(Level& level, int x, int z);
+    int heightAt(const Level& level, int x, int z) const;
+    bool isDrawn(const Level& level, const glm::ivec4& finerHole, int x, int z) const;
+    bool inChunkHole(int voxelSize, int x, int z, int top) const;
+    glm::ivec4 finerWindow(int levelIndex) const;
+
+    std::vector<Level> levels;
+
+    glm::ivec3 holeCenter;
+    int holeRadius, holeVertical;
+    unsigned int holeVersion;
+
+    std::vector<ChunkVertex> vertices; // meshing scratch
+    AABBList tileBounds;
+    std::vector<uint32_t> visibleTiles;
+    std::vector<Tile*> boundsTiles;
+
+    int sampled, remeshed, triangles;
+};
+
+#endif //CLIPMAPTERRAIN_H
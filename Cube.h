@@ -18,10 +18,13 @@ public:
 
     // Static method to initialize buffers
     static void initBuffers();
+    // Creates a VAO that pairs the shared cube vertices with a per-instance buffer
+    static unsigned int createInstanceVAO(unsigned int instanceVBO);
 
     // Methods
     void updateModelMatrix();
     void draw(unsigned int shaderProgram);
+    static void drawInstanced(unsigned int shaderProgram, unsigned int instanceVAO, int instanceCount);
     static void cleanup();
 
     // Transformation properties
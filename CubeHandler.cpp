@@ -0,0 +1,51 @@
+#include "CubeHandler.h"
+#include "CubeHandlerArena.h"
+
+// Split cube
+void splitCube(CubeHandler& cubeHandler, CubeHandlerArena* arena) {
+    if (cubeHandler.isSplit) return; // Already split
+    float childSize = cubeHandler.size / 2.0f; // Each child cube is eight the size
+    float offset = childSize / 2.0f; // Offset from the parent cubes center
+
+    std::array<Cube, 8> childCubes;
+    int index = 0;
+    for (int dx = -1; dx <= 1; dx+= 2) {
+        for (int dy = -1; dy <= 1; dy += 2) {
+            for (int dz = -1; dz <= 1; dz += 2) {
+                glm::vec3 childPos = cubeHandler.cube.position + glm::vec3(dx*offset, dy*offset, dz*offset);
+                childCubes[index] = Cube(childPos, glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(childSize));
+                index++;
+            }
+        }
+    }
+
+    if (arena != nullptr) {
+        // All 8 siblings in one contiguous block
+        CubeHandler* first = arena->allocateSiblings(childCubes, childSize);
+        for (int i = 0; i < 8; i++) {
+            cubeHandler.children[i] = first + i;
+        }
+        cubeHandler.arena = arena;
+    } else {
+        for (int i = 0; i < 8; i++) {
+            cubeHandler.children[i] = new CubeHandler(childCubes[i], childSize);
+        }
+    }
+    cubeHandler.isSplit = true;
+}
+
+// Test build cube tree
+void buildTestCubeTree(CubeHandler& cubeHandler, int maxDepth, CubeHandlerArena* arena) {
+    if (maxDepth <= 0) return; // Base case: stop recursion
+
+    splitCube(cubeHandler, arena);
+    int index = 0;
+    for (auto child : cubeHandler.children) {
+        if (index == 0 || index == 3 || index == 5 || index == 7) {
+            if (child != nullptr) {
+                buildTestCubeTree(*child, maxDepth-1, arena);
+            }
+        }
+        index++;
+    }
+}
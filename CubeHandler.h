@@ -0,0 +1,38 @@
+#ifndef CUBEHANDLER_H
+#define CUBEHANDLER_H
+
+#include <array>
+#include "Cube.h"
+
+class CubeHandlerArena;
+
+// Node of the cube tree used by splitCube/renderCubes
+struct CubeHandler {
+    Cube cube;
+    float size;
+    bool isSplit;
+    std::array<CubeHandler*, 8> children{};
+    CubeHandlerArena* arena; // owner of the children, nullptr if they came from new
+    unsigned char cullPlane; // frustum plane that rejected this node last, tested first next frame
+
+    CubeHandler(const Cube& cube_, float s)
+        : cube(cube_), size(s), isSplit(false), arena(nullptr), cullPlane(0) {
+        children.fill(nullptr);
+    }
+
+    ~CubeHandler() {
+        // Arena-owned children are released by the arena
+        if (arena != nullptr) return;
+
+        // Recursively delete child cubes
+        for (auto child : children) {
+            delete child;
+        }
+    }
+};
+
+// Split a cube into 8 children, taken from the arena when one is given
+void splitCube(CubeHandler& cubeHandler, CubeHandlerArena* arena = nullptr);
+void buildTestCubeTree(CubeHandler& cubeHandler, int maxDepth, CubeHandlerArena* arena = nullptr);
+
+#endif //CUBEHANDLER_H
@@ -0,0 +1,66 @@
+#include "CubeHandlerArena.h"
+#include <new>
+
+CubeHandlerArena::CubeHandlerArena(size_t blocksPerSlab)
+    : blocksPerSlab(blocksPerSlab), liveBlocks(0) {}
+
+CubeHandlerArena::~CubeHandlerArena() {
+    clear();
+}
+
+CubeHandler* CubeHandlerArena::allocateSiblings(const std::array<Cube, 8>& cubes, float size) {
+    if (freeBlocks.empty()) {
+        addSlab();
+    }
+    Block* block = freeBlocks.back();
+    freeBlocks.pop_back();
+    liveBlocks++;
+
+    auto* first = reinterpret_cast<CubeHandler*>(block->storage);
+    for (int i = 0; i < 8; i++) {
+        new (first + i) CubeHandler(cubes[i], size);
+    }
+    return first;
+}
+
+void CubeHandlerArena::releaseChildren(CubeHandler& cubeHandler) {
+    if (!cubeHandler.isSplit || cubeHandler.arena != this) return;
+
+    releaseBlock(cubeHandler.children[0]);
+    cubeHandler.children.fill(nullptr);
+    cubeHandler.isSplit = false;
+    cubeHandler.arena = nullptr;
+}
+
+void CubeHandlerArena::clear() {
+    // Nodes hold no resources of their own, so every block can be handed back
+    // without walking the trees
+    freeBlocks.clear();
+    for (auto& slab : slabs) {
+        for (size_t i = 0; i < blocksPerSlab; i++) {
+            freeBlocks.push_back(&slab[i]);
+        }
+    }
+    liveBlocks = 0;
+}
+
+void CubeHandlerArena::releaseBlock(CubeHandler* first) {
+    for (int i = 0; i < 8; i++) {
+        CubeHandler& child = first[i];
+        if (child.isSplit && child.arena == this) {
+            releaseBlock(child.children[0]);
+        }
+        child.~CubeHandler();
+    }
+    freeBlocks.push_back(reinterpret_cast<Block*>(first));
+    liveBlocks--;
+}
+
+void CubeHandlerArena::addSlab() {
+    slabs.emplace_back(new Block[blocksPerSlab]);
+    Block* slab = slabs.back().get();
+    // Push in reverse so blocks are handed out in address order
+    for (size_t i = blocksPerSlab; i > 0; i--) {
+        freeBlocks.push_back(&slab[i - 1]);
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef CUBEHANDLERARENA_H
+#define CUBEHANDLERARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "CubeHandler.h"
+
+// Allocator for cube tree nodes. The 8 children created by one split are a
+// single contiguous block carved out of larger slabs; released blocks go on a
+// free list. Subtrees can be released individually and a whole tree (e.g. a
+// chunk's) at once with clear().
+class CubeHandlerArena {
+public:
+    explicit CubeHandlerArena(size_t blocksPerSlab = 256);
+    ~CubeHandlerArena();
+
+    CubeHandlerArena(const CubeHandlerArena&) = delete;
+    CubeHandlerArena& operator=(const CubeHandlerArena&) = delete;
+
+    // Construct 8 siblings in one block, returns the first
+    CubeHandler* allocateSiblings(const std::array<Cube, 8>& cubes, float size);
+
+    // Release every descendant of cubeHandler and turn it back into a leaf
+    void releaseChildren(CubeHandler& cubeHandler);
+
+    // Release every node at once. Roots that were split from this arena must
+    // not be used (or destroyed expecting children) afterwards.
+    void clear();
+
+    // Counters
+    size_t liveNodes() const { return liveBlocks * 8; }
+    size_t bytesInUse() const { return liveBlocks * sizeof(Block); }
+    size_t bytesReserved() const { return slabs.size() * blocksPerSlab * sizeof(Block); }
+
+private:
+    struct Block {
+        alignas(CubeHandler) unsigned char storage[8 * sizeof(CubeHandler)];
+    };
+
+    void releaseBlock(CubeHandler* first);
+    void addSlab();
+
+    size_t blocksPerSlab;
+    size_t liveBlocks;
+    std::vector<std::unique_ptr<Block[]>> slabs;
+    std::vector<Block*> freeBlocks;
+};
+
+#endif //CUBEHANDLERARENA_H
@@ -0,0 +1,67 @@
+#include "CubeInstanceBuffer.h"
+#include <algorithm>
+#include <glad/glad.h>
+#include "Cube.h"
+
+CubeInstanceBuffer::CubeInstanceBuffer()
+    : VAO(0), VBO(0), uploadedCount(0), capacity(0) {}
+
+void CubeInstanceBuffer::clear() {
+    instances.clear();
+}
+
+void CubeInstanceBuffer::add(const glm::vec3& position, float scale) {
+    instances.emplace_back(position, scale);
+}
+
+void CubeInstanceBuffer::upload() {
+    const size_t bytes = instances.size() * sizeof(glm::vec4);
+    prepareStorage(instances.size());
+    if (bytes > 0) {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    uploadedCount = static_cast<int>(instances.size());
+}
+
+void CubeInstanceBuffer::upload(UploadRing& ring, UploadSpan& span) {
+    // The staged list isn't used, the instances come straight from the span
+    instances.clear();
+    uploadedCount = static_cast<int>(span.size / sizeof(glm::vec4));
+    prepareStorage(uploadedCount);
+    if (uploadedCount > 0) {
+        ring.copyTo(span, VBO, 0);
+    } else {
+        ring.release(span);
+    }
+}
+
+void CubeInstanceBuffer::prepareStorage(size_t count) {
+    if (VAO == 0) {
+        glGenBuffers(1, &VBO);
+        VAO = Cube::createInstanceVAO(VBO);
+    }
+    if (count == 0) return;
+
+    // Grow the storage, or orphan the old one so the driver doesn't wait on the previous frame
+    capacity = std::max(capacity, count);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void CubeInstanceBuffer::draw(unsigned int shaderProgram) const {
+    Cube::drawInstanced(shaderProgram, VAO, uploadedCount);
+}
+
+void CubeInstanceBuffer::cleanup() {
+    if (VAO != 0) {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        VAO = 0;
+        VBO = 0;
+    }
+    uploadedCount = 0;
+    capacity = 0;
+}
@@ -0,0 +1,37 @@
+#ifndef CUBEINSTANCEBUFFER_H
+#define CUBEINSTANCEBUFFER_H
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "UploadRing.h"
+
+// Per-chunk list of cube instances drawn with one glDrawArraysInstanced call
+class CubeInstanceBuffer {
+public:
+    CubeInstanceBuffer();
+
+    // Staging (CPU side)
+    void clear();
+    void add(const glm::vec3& position, float scale);
+    void assign(std::vector<glm::vec4>&& newInstances) { instances = std::move(newInstances); }
+    int size() const { return static_cast<int>(instances.size()); }
+
+    // Upload the staged instances and draw them
+    void upload();
+    // Upload instances written into an upload ring span instead (consumes the span)
+    void upload(UploadRing& ring, UploadSpan& span);
+    void draw(unsigned int shaderProgram) const;
+    void cleanup();
+
+    int uploadedSize() const { return uploadedCount; }
+
+private:
+    void prepareStorage(size_t count);
+
+    std::vector<glm::vec4> instances; // xyz = position, w = scale
+    unsigned int VAO, VBO;
+    int uploadedCount;
+    size_t capacity; // in instances
+};
+
+#endif //CUBEINSTANCEBUFFER_H
@@ -1,5 +1,21 @@
 #include "Frustum.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+void AABBList::clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void AABBList::add(const glm::vec3& minPoint, const glm::vec3& maxPoint) {
+    minX.push_back(minPoint.x); minY.push_back(minPoint.y); minZ.push_back(minPoint.z);
+    maxX.push_back(maxPoint.x); maxY.push_back(maxPoint.y); maxZ.push_back(maxPoint.z);
+}
+
 Frustum::Frustum() {}
 
 void Frustum::update(const glm::mat4& viewProjection, float margin) {
@@ -69,4 +85,147 @@ bool Frustum::isAABBInFrustum(const glm::vec3& minPoint, const glm::vec3& maxPoi
         }
      }
     return true;
-}
\ No newline at end of file
+}
+
+FrustumTest Frustum::classifyAABB(const glm::vec3& minPoint, const glm::vec3& maxPoint, unsigned& planeMask,
+                                  unsigned char& lastRejectPlane, int& planeTests) const {
+    // Returns false if the box is outside plane i, drops i from the mask if
+    // the box is entirely on the inner side
+    auto testPlane = [&](int i) {
+        const glm::vec4& plane = planes[i];
+        glm::vec3 p = minPoint; // corner furthest along the normal
+        glm::vec3 n = maxPoint; // corner furthest against it
+        if (plane.x >= 0) { p.x = maxPoint.x; n.x = minPoint.x; }
+        if (plane.y >= 0) { p.y = maxPoint.y; n.y = minPoint.y; }
+        if (plane.z >= 0) { p.z = maxPoint.z; n.z = minPoint.z; }
+
+        planeTests++;
+        if (glm::dot(glm::vec3(plane), p) + plane.w < 0) return false;
+        if (glm::dot(glm::vec3(plane), n) + plane.w >= 0) planeMask &= ~(1u << i);
+        return true;
+    };
+
+    // The plane that rejected this box last time most likely still does
+    const int first = lastRejectPlane;
+    if ((planeMask & (1u << first)) && !testPlane(first)) return FrustumTest::Outside;
+
+    for (int i = 0; i < 6; i++) {
+        if (i == first || !(planeMask & (1u << i))) continue;
+        if (!testPlane(i)) {
+            lastRejectPlane = static_cast<unsigned char>(i);
+            return FrustumTest::Outside;
+        }
+    }
+    return planeMask == 0 ? FrustumTest::Inside : FrustumTest::Intersecting;
+}
+
+namespace {
+
+// Runs the same p-vertex test as isAABBInFrustum over a whole AABBList and
+// hands emit(first, bits) a bitmask for each group of lanes starting at box
+// `first`. Instead of branching per box, the min/max pick for every plane is
+// a blend with a per-plane sign mask.
+template <typename Emit>
+void cullBatch(const std::array<glm::vec4, 6>& planes, const AABBList& boxes, Emit emit) {
+    const size_t count = boxes.size();
+    size_t i = 0;
+
+#if defined(__AVX__)
+    __m256 nx[6], ny[6], nz[6], nw[6], sx[6], sy[6], sz[6];
+    for (int p = 0; p < 6; ++p) {
+        nx[p] = _mm256_set1_ps(planes[p].x);
+        ny[p] = _mm256_set1_ps(planes[p].y);
+        nz[p] = _mm256_set1_ps(planes[p].z);
+        nw[p] = _mm256_set1_ps(planes[p].w);
+        sx[p] = _mm256_cmp_ps(nx[p], _mm256_setzero_ps(), _CMP_GE_OQ);
+        sy[p] = _mm256_cmp_ps(ny[p], _mm256_setzero_ps(), _CMP_GE_OQ);
+        sz[p] = _mm256_cmp_ps(nz[p], _mm256_setzero_ps(), _CMP_GE_OQ);
+    }
+    for (; i + 8 <= count; i += 8) {
+        __m256 minX = _mm256_loadu_ps(&boxes.minX[i]);
+        __m256 minY = _mm256_loadu_ps(&boxes.minY[i]);
+        __m256 minZ = _mm256_loadu_ps(&boxes.minZ[i]);
+        __m256 maxX = _mm256_loadu_ps(&boxes.maxX[i]);
+        __m256 maxY = _mm256_loadu_ps(&boxes.maxY[i]);
+        __m256 maxZ = _mm256_loadu_ps(&boxes.maxZ[i]);
+        __m256 outside = _mm256_setzero_ps();
+        for (int p = 0; p < 6; ++p) {
+            __m256 px = _mm256_blendv_ps(minX, maxX, sx[p]);
+            __m256 py = _mm256_blendv_ps(minY, maxY, sy[p]);
+            __m256 pz = _mm256_blendv_ps(minZ, maxZ, sz[p]);
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx[p], px), _mm256_mul_ps(ny[p], py)),
+                                     _mm256_add_ps(_mm256_mul_ps(nz[p], pz), nw[p]));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+        emit(i, static_cast<uint32_t>(~_mm256_movemask_ps(outside) & 0xFF));
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 nx[6], ny[6], nz[6], nw[6], sx[6], sy[6], sz[6];
+    for (int p = 0; p < 6; ++p) {
+        nx[p] = _mm_set1_ps(planes[p].x);
+        ny[p] = _mm_set1_ps(planes[p].y);
+        nz[p] = _mm_set1_ps(planes[p].z);
+        nw[p] = _mm_set1_ps(planes[p].w);
+        sx[p] = _mm_cmpge_ps(nx[p], _mm_setzero_ps());
+        sy[p] = _mm_cmpge_ps(ny[p], _mm_setzero_ps());
+        sz[p] = _mm_cmpge_ps(nz[p], _mm_setzero_ps());
+    }
+    // SSE2 has no blendv, so select with and/andnot/or
+    auto select = [](__m128 a, __m128 b, __m128 mask) {
+        return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+    };
+    for (; i + 4 <= count; i += 4) {
+        __m128 minX = _mm_loadu_ps(&boxes.minX[i]);
+        __m128 minY = _mm_loadu_ps(&boxes.minY[i]);
+        __m128 minZ = _mm_loadu_ps(&boxes.minZ[i]);
+        __m128 maxX = _mm_loadu_ps(&boxes.maxX[i]);
+        __m128 maxY = _mm_loadu_ps(&boxes.maxY[i]);
+        __m128 maxZ = _mm_loadu_ps(&boxes.maxZ[i]);
+        __m128 outside = _mm_setzero_ps();
+        for (int p = 0; p < 6; ++p) {
+            __m128 px = select(minX, maxX, sx[p]);
+            __m128 py = select(minY, maxY, sy[p]);
+            __m128 pz = select(minZ, maxZ, sz[p]);
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], px), _mm_mul_ps(ny[p], py)),
+                                  _mm_add_ps(_mm_mul_ps(nz[p], pz), nw[p]));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+        }
+        emit(i, static_cast<uint32_t>(~_mm_movemask_ps(outside) & 0xF));
+    }
+#endif
+
+    // Scalar tail (and the whole list on targets without SSE)
+    for (; i < count; ++i) {
+        bool visible = true;
+        for (const auto& plane : planes) {
+            float px = plane.x >= 0 ? boxes.maxX[i] : boxes.minX[i];
+            float py = plane.y >= 0 ? boxes.maxY[i] : boxes.minY[i];
+            float pz = plane.z >= 0 ? boxes.maxZ[i] : boxes.minZ[i];
+            if (plane.x * px + plane.y * py + plane.z * pz + plane.w < 0) {
+                visible = false;
+                break;
+            }
+        }
+        emit(i, visible ? 1u : 0u);
+    }
+}
+
+}
+
+void Frustum::cullAABBMask(const AABBList& boxes, std::vector<uint32_t>& visibleBits) const {
+    visibleBits.assign((boxes.size() + 31) / 32, 0);
+    // Groups are 1, 4 or 8 boxes and start aligned to their size, so a group
+    // never straddles two words
+    cullBatch(planes, boxes, [&](size_t first, uint32_t bits) {
+        visibleBits[first / 32] |= bits << (first % 32);
+    });
+}
+
+void Frustum::cullAABBIndices(const AABBList& boxes, std::vector<uint32_t>& visibleIndices) const {
+    visibleIndices.clear();
+    cullBatch(planes, boxes, [&](size_t first, uint32_t bits) {
+        for (size_t lane = 0; bits; ++lane, bits >>= 1) {
+            if (bits & 1) visibleIndices.push_back(static_cast<uint32_t>(first + lane));
+        }
+    });
+}
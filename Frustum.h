@@ -7,6 +7,28 @@
 
 #include <glm/glm.hpp>
 #include <array>
+#include <cstdint>
+#include <vector>
+
+// Boxes in structure-of-arrays layout for batch culling
+struct AABBList {
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    void clear();
+    void add(const glm::vec3& minPoint, const glm::vec3& maxPoint);
+    size_t size() const { return minX.size(); }
+};
+
+// Result of classifyAABB
+enum class FrustumTest {
+    Outside,
+    Intersecting,
+    Inside
+};
+
+// Plane mask with every plane still to be tested (bit i = planes[i])
+constexpr unsigned FRUSTUM_ALL_PLANES = 0x3F;
 
 class Frustum {
 public:
@@ -15,6 +37,20 @@ public:
     bool isPointInFrustum(const glm::vec3& point) const;
     bool isAABBInFrustum(const glm::vec3& minPoint, const glm::vec3& maxPoint) const;
 
+    // Hierarchical test. Only the planes set in planeMask are checked, and
+    // planes the box is fully inside of are cleared from it so children can
+    // skip them; an empty mask means Inside. lastRejectPlane is tested first
+    // and updated when a plane rejects the box. planeTests counts the planes
+    // actually evaluated.
+    FrustumTest classifyAABB(const glm::vec3& minPoint, const glm::vec3& maxPoint, unsigned& planeMask,
+                             unsigned char& lastRejectPlane, int& planeTests) const;
+
+    // Batch versions of isAABBInFrustum, 4 (SSE) or 8 (AVX) boxes per step.
+    // cullAABBMask sets bit i of visibleBits (32 boxes per word) for every
+    // visible box, cullAABBIndices writes the indices of the visible boxes.
+    void cullAABBMask(const AABBList& boxes, std::vector<uint32_t>& visibleBits) const;
+    void cullAABBIndices(const AABBList& boxes, std::vector<uint32_t>& visibleIndices) const;
+
 private:
     std::array<glm::vec4, 6> planes;
     float margin;
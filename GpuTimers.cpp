@@ -0,0 +1,97 @@
+#include "GpuTimers.h"
+#include <chrono>
+#include <glad/glad.h>
+
+namespace {
+    int64_t cpuNowNs() {
+        using Clock = std::chrono::steady_clock;
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+}
+
+GpuTimers::GpuTimers(const std::vector<const char*>& passNames)
+    : running(passNames.size(), -1), begun(passNames.size(), 0), cpuStart(passNames.size(), 0), newestResult(passNames.size(), 0),
+      frame(0), skipped(0) {
+    for (const char* name : passNames) {
+        passList.push_back(Pass{name});
+    }
+    queries.resize(passNames.size() * FRAMES);
+    for (Query& query : queries) {
+        glGenQueries(1, &query.begin);
+        glGenQueries(1, &query.end);
+    }
+}
+
+void GpuTimers::beginFrame() {
+    frame++;
+    skipped = 0;
+    for (size_t pass = 0; pass < passList.size(); pass++) {
+        passList[pass].submitted = begun[pass] != 0;
+        begun[pass] = 0;
+    }
+    collect();
+}
+
+void GpuTimers::collect() {
+    for (size_t pass = 0; pass < passList.size(); pass++) {
+        for (int slot = 0; slot < FRAMES; slot++) {
+            Query& query = queries[pass * FRAMES + slot];
+            if (!query.pending) continue;
+
+            // The end stamp comes back last
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(query.end, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+
+            GLuint64 beginNs = 0, endNs = 0;
+            glGetQueryObjectui64v(query.begin, GL_QUERY_RESULT, &beginNs);
+            glGetQueryObjectui64v(query.end, GL_QUERY_RESULT, &endNs);
+            const GLuint64 elapsedNs = endNs > beginNs ? endNs - beginNs : 0;
+            query.pending = false;
+            // Slots can finish out of order, keep the newest
+            if (query.frame >= newestResult[pass]) {
+                newestResult[pass] = query.frame;
+                passList[pass].gpuMs = static_cast<double>(elapsedNs) / 1e6;
+                passList[pass].measured = true;
+            }
+        }
+    }
+}
+
+void GpuTimers::begin(int pass) {
+    cpuStart[pass] = cpuNowNs();
+    begun[pass] = 1;
+
+    // A slot still in flight is skipped rather than waited on
+    const int slot = static_cast<int>(frame % FRAMES);
+    Query& query = queries[pass * FRAMES + slot];
+    if (query.pending) {
+        skipped++;
+        return;
+    }
+    glQueryCounter(query.begin, GL_TIMESTAMP);
+    running[pass] = slot;
+}
+
+void GpuTimers::end(int pass, int triangles, int drawCalls) {
+    if (running[pass] >= 0) {
+        Query& query = queries[pass * FRAMES + running[pass]];
+        glQueryCounter(query.end, GL_TIMESTAMP);
+        query.pending = true;
+        query.frame = frame;
+        running[pass] = -1;
+    }
+
+    Pass& timing = passList[pass];
+    timing.cpuMs = static_cast<double>(cpuNowNs() - cpuStart[pass]) / 1e6;
+    timing.triangles = triangles;
+    timing.drawCalls = drawCalls;
+}
+
+void GpuTimers::cleanup() {
+    for (Query& query : queries) {
+        glDeleteQueries(1, &query.begin);
+        glDeleteQueries(1, &query.end);
+        query = Query();
+    }
+}
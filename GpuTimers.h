@@ -0,0 +1,65 @@
+#ifndef GPUTIMERS_H
+#define GPUTIMERS_H
+
+#include <cstdint>
+#include <vector>
+
+// GPU time of each render pass from a pair of GL_TIMESTAMP queries around it
+// (core since GL 3.3). GL_TIME_ELAPSED would need one query instead of two,
+// but Mesa's llvmpipe returns garbage for it, and timestamps let passes nest.
+// Every pass owns FRAMES query pairs used in turn, and results are only read
+// once GL reports them available, so the numbers lag a frame or two but
+// nothing ever waits on the GPU. The CPU time spent submitting the pass is
+// measured alongside.
+class GpuTimers {
+public:
+    static const int FRAMES = 3;
+
+    struct Pass {
+        const char* name;
+        double gpuMs = 0.0; // newest available result
+        double cpuMs = 0.0; // last frame
+        int triangles = 0;  // last frame
+        int drawCalls = 0;  // last frame
+        bool measured = false; // a GPU result came back
+        bool submitted = false; // last frame, gpuMs is stale otherwise
+    };
+
+    // Needs a current GL context
+    explicit GpuTimers(const std::vector<const char*>& passNames);
+
+    GpuTimers(const GpuTimers&) = delete;
+    GpuTimers& operator=(const GpuTimers&) = delete;
+
+    // Once per frame before the passes: collect the finished queries
+    void beginFrame();
+    // Read back the results that are available now, without starting a frame
+    // (after a glFinish every issued query is)
+    void collect();
+
+    void begin(int pass);
+    void end(int pass, int triangles = 0, int drawCalls = 0);
+
+    const std::vector<Pass>& passes() const { return passList; }
+    int skippedQueries() const { return skipped; } // last frame, all queries of a pass still in flight
+
+    void cleanup();
+
+private:
+    struct Query {
+        unsigned int begin = 0, end = 0; // timestamp queries
+        bool pending = false;
+        uint64_t frame = 0; // frame it was issued in
+    };
+
+    std::vector<Pass> passList;
+    std::vector<Query> queries; // FRAMES per pass
+    std::vector<int> running;   // query slot of each pass between begin and end, -1 otherwise
+    std::vector<char> begun;    // pass was begun since the last beginFrame
+    std::vector<int64_t> cpuStart;
+    std::vector<uint64_t> newestResult; // frame of the result in gpuMs
+    uint64_t frame;
+    int skipped;
+};
+
+#endif //GPUTIMERS_H
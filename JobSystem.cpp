@@ -0,0 +1,131 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <string>
+#include "Profiler.h"
+
+namespace {
+
+// Index of the worker running on this thread, -1 elsewhere
+thread_local int currentWorker = -1;
+
+// Heap order: lowest priority value on top, then oldest first
+struct EntryAfter {
+    template <typename T>
+    bool operator()(const T& a, const T& b) const {
+        if (a.priority != b.priority) return a.priority > b.priority;
+        return a.sequence > b.sequence;
+    }
+};
+
+}
+
+JobSystem::JobSystem(unsigned int threadCount)
+    : running(true), queued(0), active(0), cancelled(0), sequence(0), nextQueue(0) {
+    if (threadCount == 0) {
+        const unsigned int hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+
+    for (unsigned int i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&JobSystem::workerLoop, this, static_cast<int>(i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    shutdown();
+}
+
+void JobSystem::submit(Job job, int priority, CancelToken cancelToken) {
+    const int target = currentWorker >= 0
+        ? currentWorker
+        : static_cast<int>(nextQueue.fetch_add(1) % queues.size());
+    {
+        // Counted before it is pushed so a worker popping it never takes queued below 0
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queued++;
+    }
+    push(target, Entry{priority, sequence.fetch_add(1), std::move(job), std::move(cancelToken)});
+    wake.notify_one();
+}
+
+void JobSystem::waitIdle() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    idle.wait(lock, [this] { return (queued.load() == 0 && active.load() == 0) || !running.load(); });
+}
+
+void JobSystem::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (!running.load()) return;
+        running = false;
+    }
+    wake.notify_all();
+    idle.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+
+    for (auto& queue : queues) {
+        queue->heap.clear();
+    }
+    queued = 0;
+}
+
+void JobSystem::workerLoop(int index) {
+    currentWorker = index;
+    PROFILE_THREAD(("Worker " + std::to_string(index)).c_str());
+    const int queueCount = static_cast<int>(queues.size());
+
+    while (running.load()) {
+        Entry entry;
+        // Own queue first, then steal starting from the next worker
+        bool found = pop(index, entry);
+        for (int i = 1; !found && i < queueCount; i++) {
+            found = pop((index + i) % queueCount, entry);
+        }
+
+        if (found) {
+            if (entry.cancelled && entry.cancelled->load()) {
+                cancelled++;
+            } else {
+                entry.job();
+            }
+
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            active--;
+            if (queued.load() == 0 && active.load() == 0) {
+                idle.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return queued.load() > 0 || !running.load(); });
+    }
+}
+
+bool JobSystem::pop(int queueIndex, Entry& entry) {
+    WorkerQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.heap.empty()) return false;
+
+    std::pop_heap(queue.heap.begin(), queue.heap.end(), EntryAfter());
+    entry = std::move(queue.heap.back());
+    queue.heap.pop_back();
+
+    // Counted as active before it stops being queued so waitIdle never sees a gap
+    active++;
+    queued--;
+    return true;
+}
+
+void JobSystem::push(int queueIndex, Entry entry) {
+    WorkerQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.heap.push_back(std::move(entry));
+    std::push_heap(queue.heap.begin(), queue.heap.end(), EntryAfter());
+}
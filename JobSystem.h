@@ -0,0 +1,75 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Set to true to skip a job that hasn't started yet
+using CancelToken = std::shared_ptr<const std::atomic<bool>>;
+
+// Work-stealing thread pool. Every worker owns a priority queue (lowest
+// priority value runs first); jobs submitted from a worker go to its own queue,
+// jobs from other threads are spread round-robin, and idle workers steal from
+// the others.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // 0 = one worker per hardware thread, minus one for the render thread
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void submit(Job job, int priority = 0, CancelToken cancelled = nullptr);
+
+    // Block until every queued job has run (or been cancelled)
+    void waitIdle();
+
+    // Stop the workers, queued jobs are dropped. Called by the destructor.
+    void shutdown();
+
+    int threadCount() const { return static_cast<int>(threads.size()); }
+    int pendingJobs() const { return queued.load(); }
+    uint64_t cancelledJobs() const { return cancelled.load(); }
+
+private:
+    struct Entry {
+        int priority;
+        uint64_t sequence; // FIFO among equal priorities
+        Job job;
+        CancelToken cancelled;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::vector<Entry> heap;
+    };
+
+    void workerLoop(int index);
+    bool pop(int queueIndex, Entry& entry);
+    void push(int queueIndex, Entry entry);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::atomic<bool> running;
+
+    std::atomic<int> queued;
+    std::atomic<int> active;
+    std::atomic<uint64_t> cancelled;
+    std::atomic<uint64_t> sequence;
+    std::atomic<unsigned int> nextQueue;
+};
+
+#endif //JOBSYSTEM_H
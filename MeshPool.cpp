@@ -0,0 +1,217 @@
+#include "MeshPool.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <glad/glad.h>
+
+int MeshPool::packedLoc = -1;
+int MeshPool::originsLoc = -1;
+int MeshPool::pageShiftLoc = -1;
+
+MeshPool::MeshPool(int maxQuadsPerMesh, int initialPages)
+    : VAO(0), vertexBuffer(0), indexBuffer(0), originBuffer(0), originTexture(0), commandBuffer(0),
+      maxQuads(maxQuadsPerMesh), capacity(0), pagesInUse(0), indirect(GLAD_GL_VERSION_4_3 != 0) {
+    // Shared quad index buffer, the base vertex of each draw picks the mesh
+    std::vector<uint32_t> indices;
+    indices.reserve(static_cast<size_t>(maxQuads) * 6);
+    for (uint32_t quad = 0; quad < static_cast<uint32_t>(maxQuads); quad++) {
+        const uint32_t first = quad * 4;
+        for (uint32_t corner : {0u, 1u, 2u, 2u, 3u, 0u}) {
+            indices.push_back(first + corner);
+        }
+    }
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &indexBuffer);
+    glGenBuffers(1, &originBuffer);
+    glGenBuffers(1, &commandBuffer);
+    glGenTextures(1, &originTexture);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(3);
+    glBindVertexArray(0);
+
+    grow(initialPages);
+}
+
+MeshPool::Allocation MeshPool::allocate(const std::vector<ChunkVertex>& vertices, const glm::vec3& origin, float scale) {
+    Allocation allocation = allocatePages(static_cast<int>(vertices.size() / 4), origin, scale);
+    if (allocation.quadCount == 0) return allocation;
+
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(allocation.firstPage) * PAGE_VERTICES * sizeof(ChunkVertex),
+                    static_cast<GLsizeiptr>(allocation.quadCount) * 4 * sizeof(ChunkVertex), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return allocation;
+}
+
+MeshPool::Allocation MeshPool::allocate(UploadRing& ring, UploadSpan& span, const glm::vec3& origin, float scale) {
+    Allocation allocation = allocatePages(static_cast<int>(span.size / (4 * sizeof(ChunkVertex))), origin, scale);
+    if (allocation.quadCount == 0) {
+        ring.release(span);
+        return allocation;
+    }
+
+    span.size = static_cast<size_t>(allocation.quadCount) * 4 * sizeof(ChunkVertex);
+    ring.copyTo(span, vertexBuffer, static_cast<size_t>(allocation.firstPage) * PAGE_VERTICES * sizeof(ChunkVertex));
+    return allocation;
+}
+
+void MeshPool::release(Allocation& allocation) {
+    if (allocation.pageCount > 0) {
+        freeRange(allocation.firstPage, allocation.pageCount);
+        pagesInUse -= allocation.pageCount;
+    }
+    allocation = Allocation();
+}
+
+void MeshPool::queue(const Allocation& allocation) {
+    if (allocation.quadCount == 0) return;
+    commands.push_back({static_cast<unsigned int>(allocation.quadCount) * 6, 1, 0,
+                        allocation.firstPage * PAGE_VERTICES, 0});
+}
+
+int MeshPool::drawQueued(unsigned int shaderProgram) {
+    if (commands.empty()) return 0;
+
+    glUseProgram(shaderProgram);
+    glUniform1i(packedLoc, GL_TRUE);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_BUFFER, originTexture);
+    glUniform1i(originsLoc, 0);
+    glUniform1i(pageShiftLoc, PAGE_SHIFT);
+
+    glBindVertexArray(VAO);
+    if (indirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(),
+                     GL_STREAM_DRAW);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(commands.size()), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    } else {
+        counts.clear();
+        baseVertices.clear();
+        for (const DrawElementsIndirectCommand& command : commands) {
+            counts.push_back(static_cast<int>(command.count));
+            baseVertices.push_back(command.baseVertex);
+        }
+        indexOffsets.assign(commands.size(), nullptr);
+        glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, indexOffsets.data(),
+                                      static_cast<GLsizei>(commands.size()), baseVertices.data());
+    }
+    glBindVertexArray(0);
+
+    // The cube paths share the program
+    glUniform1i(packedLoc, GL_FALSE);
+    commands.clear();
+    return 1;
+}
+
+void MeshPool::cleanup() {
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    glDeleteBuffers(1, &originBuffer);
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteTextures(1, &originTexture);
+    VAO = vertexBuffer = indexBuffer = originBuffer = commandBuffer = originTexture = 0;
+    freeRanges.clear();
+    capacity = 0;
+    pagesInUse = 0;
+}
+
+MeshPool::Allocation MeshPool::allocatePages(int quadCount, const glm::vec3& origin, float scale) {
+    Allocation allocation;
+    if (quadCount > maxQuads) {
+        // Every mesher stays under MAX_CHUNK_QUADS, a bigger mesh is a bug in the caller
+        std::cerr << "MeshPool: mesh of " << quadCount << " quads is over the " << maxQuads
+                  << " quad limit, not drawn" << std::endl;
+        return allocation;
+    }
+    allocation.quadCount = quadCount;
+    if (allocation.quadCount == 0) return allocation;
+
+    const int pages = (allocation.quadCount + PAGE_QUADS - 1) / PAGE_QUADS;
+    auto fit = [&] {
+        return std::find_if(freeRanges.begin(), freeRanges.end(), [&](const auto& range) { return range.second >= pages; });
+    };
+    auto range = fit();
+    if (range == freeRanges.end()) {
+        grow(pages);
+        range = fit();
+    }
+
+    // Take the front of the range
+    allocation.firstPage = range->first;
+    allocation.pageCount = pages;
+    const int remaining = range->second - pages;
+    freeRanges.erase(range);
+    if (remaining > 0) freeRanges.emplace(allocation.firstPage + pages, remaining);
+    pagesInUse += pages;
+
+    std::fill_n(origins.begin() + allocation.firstPage, pages, glm::vec4(origin, scale));
+    glBindBuffer(GL_TEXTURE_BUFFER, originBuffer);
+    glBufferSubData(GL_TEXTURE_BUFFER, static_cast<GLintptr>(allocation.firstPage) * sizeof(glm::vec4),
+                    pages * sizeof(glm::vec4), &origins[allocation.firstPage]);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    return allocation;
+}
+
+void MeshPool::grow(int minPages) {
+    const int oldCapacity = capacity;
+    const int newCapacity = std::max(oldCapacity * 2, oldCapacity + minPages);
+
+    // New vertex storage with the old contents copied over on the GPU
+    unsigned int newVertexBuffer;
+    glGenBuffers(1, &newVertexBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newVertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newCapacity) * PAGE_VERTICES * sizeof(ChunkVertex),
+                 nullptr, GL_DYNAMIC_DRAW);
+    if (oldCapacity > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, vertexBuffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                            static_cast<GLsizeiptr>(oldCapacity) * PAGE_VERTICES * sizeof(ChunkVertex));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &vertexBuffer);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    vertexBuffer = newVertexBuffer;
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void*)0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The origins are small, re-upload them from the CPU copy
+    origins.resize(newCapacity, glm::vec4(0.0f));
+    glBindBuffer(GL_TEXTURE_BUFFER, originBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, origins.size() * sizeof(glm::vec4), origins.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_BUFFER, originTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, originBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+    capacity = newCapacity;
+    freeRange(oldCapacity, newCapacity - oldCapacity);
+}
+
+void MeshPool::freeRange(int first, int count) {
+    // Merge with the following and preceding free ranges
+    auto next = freeRanges.lower_bound(first);
+    if (next != freeRanges.end() && first + count == next->first) {
+        count += next->second;
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == first) {
+            previous->second += count;
+            return;
+        }
+    }
+    freeRanges.emplace(first, count);
+}
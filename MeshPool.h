@@ -0,0 +1,89 @@
+#ifndef MESHPOOL_H
+#define MESHPOOL_H
+
+#include <bit>
+#include <map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "ChunkVertex.h"
+#include "UploadRing.h"
+
+// Every chunk mesh lives in one big vertex buffer, carved into pages of
+// PAGE_QUADS quads. Meshes get a run of whole pages from a free list (first
+// fit, freed runs merge with their neighbours) and the buffer doubles when
+// nothing fits. The world origin and scale of each page sit in a buffer
+// texture that the vertex shader reads through gl_VertexID, so no per-draw
+// state is needed and all queued meshes go out in one
+// glMultiDrawElementsIndirect call, or glMultiDrawElementsBaseVertex on GL 3.3
+// contexts.
+class MeshPool {
+public:
+    static const int PAGE_QUADS = 64;
+    static const int PAGE_VERTICES = PAGE_QUADS * 4;
+    // vertex_shader.glsl finds a vertex's page as gl_VertexID >> PAGE_SHIFT
+    static const int PAGE_SHIFT = std::bit_width(static_cast<unsigned int>(PAGE_VERTICES)) - 1;
+    static_assert(PAGE_VERTICES == 1 << PAGE_SHIFT, "pages must hold a power of two vertices");
+
+    struct Allocation {
+        int firstPage = 0;
+        int pageCount = 0;
+        int quadCount = 0;
+    };
+
+    // Needs a current GL context. maxQuadsPerMesh sizes the shared index buffer.
+    MeshPool(int maxQuadsPerMesh, int initialPages);
+
+    MeshPool(const MeshPool&) = delete;
+    MeshPool& operator=(const MeshPool&) = delete;
+
+    // Copy a mesh in, origin is the world position its vertices are relative
+    // to and scale the world size of one vertex coordinate step. A mesh over
+    // maxQuadsPerMesh is reported and gets an empty allocation.
+    Allocation allocate(const std::vector<ChunkVertex>& vertices, const glm::vec3& origin, float scale = 1.0f);
+    // Same, from vertices written into an upload ring span (consumes the span)
+    Allocation allocate(UploadRing& ring, UploadSpan& span, const glm::vec3& origin, float scale = 1.0f);
+    void release(Allocation& allocation);
+
+    // Add a mesh to this frame's draw, then draw everything queued. Returns the
+    // number of GL draw calls issued.
+    void queue(const Allocation& allocation);
+    int drawQueued(unsigned int shaderProgram);
+
+    void cleanup();
+
+    int usedPages() const { return pagesInUse; }
+    int capacityPages() const { return capacity; }
+    bool usesIndirectDraw() const { return indirect; }
+
+    // Uniform locations, set once the shader is linked
+    static int packedLoc;
+    static int originsLoc;
+    static int pageShiftLoc;
+
+private:
+    struct DrawElementsIndirectCommand {
+        unsigned int count;
+        unsigned int instanceCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int baseInstance;
+    };
+
+    Allocation allocatePages(int quadCount, const glm::vec3& origin, float scale);
+    void grow(int minPages);
+    void freeRange(int first, int count);
+
+    unsigned int VAO, vertexBuffer, indexBuffer, originBuffer, originTexture, commandBuffer;
+    int maxQuads;
+    int capacity; // in pages
+    int pagesInUse;
+    bool indirect;
+
+    std::map<int, int> freeRanges; // first page -> page count
+    std::vector<glm::vec4> origins; // origin and scale per page, mirrors originBuffer
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<int> counts, baseVertices; // fallback path
+    std::vector<const void*> indexOffsets;
+};
+
+#endif //MESHPOOL_H
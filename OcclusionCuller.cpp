@@ -0,0 +1,306 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include "JobSystem.h"
+#include "Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define OCCLUSION_SSE2 1
+#else
+#define OCCLUSION_SSE2 0
+#endif
+
+namespace {
+
+// Corner i of a box: bit 0 picks max x, bit 1 max y, bit 2 max z
+glm::vec3 boxCorner(const glm::vec3& minPoint, const glm::vec3& maxPoint, int i) {
+    return glm::vec3(i & 1 ? maxPoint.x : minPoint.x,
+                     i & 2 ? maxPoint.y : minPoint.y,
+                     i & 4 ? maxPoint.z : minPoint.z);
+}
+
+// Box faces as corner indices, counter-clockwise seen from outside
+const int boxFaces[6][4] = {
+    {0, 4, 6, 2}, // -X
+    {1, 3, 7, 5}, // +X
+    {0, 1, 5, 4}, // -Y
+    {2, 6, 7, 3}, // +Y
+    {0, 2, 3, 1}, // -Z
+    {4, 5, 7, 6}, // +Z
+};
+
+// Linear function of the pixel position: a * x + b * y + c
+struct EdgeFunction {
+    float a, b, c;
+};
+
+// Positive on the left of a -> b, i.e. inside a counter-clockwise triangle
+EdgeFunction edgeFunction(float ax, float ay, float bx, float by) {
+    EdgeFunction e;
+    e.a = ay - by;
+    e.b = bx - ax;
+    e.c = -(e.a * ax + e.b * ay);
+    return e;
+}
+
+}
+
+OcclusionCuller::OcclusionCuller(int width, int height)
+    : width(width), height(height), viewProjection(1.0f), occluders(0), lastRasterizeMs(0.0),
+      simd(OCCLUSION_SSE2) {
+    int w = width, h = height;
+    while (true) {
+        levelSizes.emplace_back(w, h);
+        levels.emplace_back(static_cast<size_t>(w) * h, 0.0f);
+        if (w % 2 != 0 || h % 2 != 0) break; // every texel must cover exactly 2x2
+        w /= 2;
+        h /= 2;
+    }
+}
+
+void OcclusionCuller::setSimd(bool enabled) {
+    simd = enabled && OCCLUSION_SSE2;
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4& viewProjection) {
+    this->viewProjection = viewProjection;
+    triangles.clear();
+    occluders = 0;
+    std::fill(levels[0].begin(), levels[0].end(), 0.0f);
+}
+
+void OcclusionCuller::addOccluder(const glm::vec3& minPoint, const glm::vec3& maxPoint) {
+    occluders++;
+
+    // Project the corners once, shared by the 12 triangles
+    glm::vec3 screen[8]; // pixel x, pixel y, 1/w
+    bool behind[8];
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 clip = viewProjection * glm::vec4(boxCorner(minPoint, maxPoint, i), 1.0f);
+        behind[i] = clip.w < NEAR_W;
+        float invW = 1.0f / clip.w;
+        screen[i] = glm::vec3((clip.x * invW * 0.5f + 0.5f) * width,
+                              (clip.y * invW * 0.5f + 0.5f) * height,
+                              invW);
+    }
+
+    for (const auto& face : boxFaces) {
+        for (int t = 0; t < 2; t++) {
+            const int corners[3] = {face[0], face[t + 1], face[t + 2]};
+            // Skipping an occluder triangle only makes the test more conservative
+            if (behind[corners[0]] || behind[corners[1]] || behind[corners[2]]) continue;
+
+            ScreenTriangle tri;
+            float minX = std::numeric_limits<float>::max(), maxX = -minX;
+            float minY = minX, maxY = -minX;
+            for (int v = 0; v < 3; v++) {
+                const glm::vec3& p = screen[corners[v]];
+                tri.x[v] = p.x;
+                tri.y[v] = p.y;
+                tri.invW[v] = p.z;
+                minX = std::min(minX, p.x); maxX = std::max(maxX, p.x);
+                minY = std::min(minY, p.y); maxY = std::max(maxY, p.y);
+            }
+
+            // Back faces (and degenerate ones) are hidden by the front faces anyway
+            float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+            if (area <= 0.0f) continue;
+
+            // Rows whose pixel centers the triangle can cover
+            tri.minY = std::max(0, static_cast<int>(std::ceil(minY - 0.5f)));
+            tri.maxY = std::min(height - 1, static_cast<int>(std::floor(maxY - 0.5f)));
+            if (tri.minY > tri.maxY || maxX < 0.5f || minX > width - 0.5f) continue;
+
+            triangles.push_back(tri);
+        }
+    }
+}
+
+void OcclusionCuller::rasterize(JobSystem* jobs) {
+    PROFILE_ZONE("Occlusion Rasterize");
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    const int bands = height / BAND_HEIGHT;
+    if (jobs != nullptr && jobs->threadCount() > 0) {
+        // Bands are claimed from a shared counter by the workers and by this
+        // thread, so nothing waits on a worker that is still busy with a chunk.
+        // Helpers that start after every band is taken just return.
+        struct BandWork {
+            std::atomic<int> next{0};
+            std::atomic<int> left;
+        };
+        auto work = std::make_shared<BandWork>();
+        work->left = bands;
+
+        auto run = [this, work, bands] {
+            for (int band; (band = work->next.fetch_add(1)) < bands;) {
+                rasterizeBand(band);
+                if (work->left.fetch_sub(1) == 1) work->left.notify_all();
+            }
+        };
+
+        const int helpers = std::min(jobs->threadCount(), bands - 1);
+        for (int i = 0; i < helpers; i++) {
+            jobs->submit(run, std::numeric_limits<int>::min());
+        }
+        run();
+        for (int left; (left = work->left.load()) != 0;) {
+            work->left.wait(left);
+        }
+    } else {
+        for (int band = 0; band < bands; band++) {
+            rasterizeBand(band);
+        }
+    }
+
+    buildPyramid();
+    lastRasterizeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void OcclusionCuller::rasterizeBand(int band) {
+    PROFILE_ZONE("Occlusion Band");
+    const int bandMinY = band * BAND_HEIGHT;
+    const int bandMaxY = bandMinY + BAND_HEIGHT - 1;
+    float* depth = levels[0].data();
+
+    for (const ScreenTriangle& tri : triangles) {
+        const int rowStart = std::max(tri.minY, bandMinY);
+        const int rowEnd = std::min(tri.maxY, bandMaxY);
+        if (rowStart > rowEnd) continue;
+
+        const EdgeFunction e0 = edgeFunction(tri.x[1], tri.y[1], tri.x[2], tri.y[2]);
+        const EdgeFunction e1 = edgeFunction(tri.x[2], tri.y[2], tri.x[0], tri.y[0]);
+        const EdgeFunction e2 = edgeFunction(tri.x[0], tri.y[0], tri.x[1], tri.y[1]);
+
+        // 1/w is linear in screen space, interpolate it with the barycentrics
+        const float area = e0.c + e0.a * tri.x[0] + e0.b * tri.y[0];
+        const EdgeFunction z = {
+            (e0.a * tri.invW[0] + e1.a * tri.invW[1] + e2.a * tri.invW[2]) / area,
+            (e0.b * tri.invW[0] + e1.b * tri.invW[1] + e2.b * tri.invW[2]) / area,
+            (e0.c * tri.invW[0] + e1.c * tri.invW[1] + e2.c * tri.invW[2]) / area,
+        };
+
+        float minX = std::min({tri.x[0], tri.x[1], tri.x[2]});
+        float maxX = std::max({tri.x[0], tri.x[1], tri.x[2]});
+        const int colStart = std::max(0, static_cast<int>(std::floor(minX))) & ~3; // whole groups of 4
+        const int colEnd = std::min(width - 1, static_cast<int>(std::ceil(maxX)));
+
+        for (int row = rowStart; row <= rowEnd; row++) {
+            const float fy = row + 0.5f;
+            float* line = depth + static_cast<size_t>(row) * width;
+
+            // Edge and depth values of the row, shared by both paths so they round the same
+            const float e0row = e0.b * fy + e0.c;
+            const float e1row = e1.b * fy + e1.c;
+            const float e2row = e2.b * fy + e2.c;
+            const float zrow = z.b * fy + z.c;
+
+#if OCCLUSION_SSE2
+            if (simd) {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 e0a = _mm_set1_ps(e0.a), e1a = _mm_set1_ps(e1.a), e2a = _mm_set1_ps(e2.a), za = _mm_set1_ps(z.a);
+                const __m128 e0row4 = _mm_set1_ps(e0row);
+                const __m128 e1row4 = _mm_set1_ps(e1row);
+                const __m128 e2row4 = _mm_set1_ps(e2row);
+                const __m128 zrow4 = _mm_set1_ps(zrow);
+                for (int col = colStart; col <= colEnd; col += 4) {
+                    const __m128 fx = _mm_add_ps(_mm_set1_ps(col + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+                    __m128 inside = _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e0a, fx), e0row4), zero);
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e1a, fx), e1row4), zero));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(e2a, fx), e2row4), zero));
+                    if (_mm_movemask_ps(inside) == 0) continue;
+
+                    // Keep the nearest depth (largest 1/w)
+                    const __m128 old = _mm_loadu_ps(line + col);
+                    const __m128 nearest = _mm_max_ps(old, _mm_add_ps(_mm_mul_ps(za, fx), zrow4));
+                    _mm_storeu_ps(line + col, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+                }
+                continue;
+            }
+#endif
+            for (int col = colStart; col <= colEnd; col++) {
+                const float fx = col + 0.5f;
+                if (e0.a * fx + e0row < 0 || e1.a * fx + e1row < 0 || e2.a * fx + e2row < 0) continue;
+                line[col] = std::max(line[col], z.a * fx + zrow);
+            }
+        }
+    }
+}
+
+void OcclusionCuller::buildPyramid() {
+    for (size_t level = 1; level < levels.size(); level++) {
+        const std::vector<float>& below = levels[level - 1];
+        const int belowWidth = levelSizes[level - 1].x;
+        const glm::ivec2 size = levelSizes[level];
+        std::vector<float>& texels = levels[level];
+
+        for (int y = 0; y < size.y; y++) {
+            const float* row0 = below.data() + static_cast<size_t>(2 * y) * belowWidth;
+            const float* row1 = row0 + belowWidth;
+            for (int x = 0; x < size.x; x++) {
+                // Farthest of the four
+                texels[y * size.x + x] = std::min(std::min(row0[2 * x], row0[2 * x + 1]),
+                                                  std::min(row1[2 * x], row1[2 * x + 1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isAABBVisible(const glm::vec3& minPoint, const glm::vec3& maxPoint) const {
+    float minX = std::numeric_limits<float>::max(), maxX = -minX;
+    float minY = minX, maxY = -minX;
+    float nearestInvW = 0.0f;
+    for (int i = 0; i < 8; i++) {
+        glm::vec4 clip = viewProjection * glm::vec4(boxCorner(minPoint, maxPoint, i), 1.0f);
+        if (clip.w < NEAR_W) return true; // crosses the near plane
+
+        // w is linear over the box, so its nearest point is a corner
+        float invW = 1.0f / clip.w;
+        float x = (clip.x * invW * 0.5f + 0.5f) * width;
+        float y = (clip.y * invW * 0.5f + 0.5f) * height;
+        minX = std::min(minX, x); maxX = std::max(maxX, x);
+        minY = std::min(minY, y); maxY = std::max(maxY, y);
+        nearestInvW = std::max(nearestInvW, invW);
+    }
+
+    // Off screen boxes are the frustum's business
+    if (maxX < 0.0f || maxY < 0.0f || minX >= width || minY >= height) return true;
+
+    int x0 = std::max(0, static_cast<int>(minX));
+    int y0 = std::max(0, static_cast<int>(minY));
+    int x1 = std::min(width - 1, static_cast<int>(maxX));
+    int y1 = std::min(height - 1, static_cast<int>(maxY));
+
+    // Coarsest level where the box covers at most 4x4 texels
+    size_t level = 0;
+    while (level + 1 < levels.size() && ((x1 >> level) - (x0 >> level) > 3 || (y1 >> level) - (y0 >> level) > 3)) {
+        level++;
+    }
+
+    const std::vector<float>& texels = levels[level];
+    const int levelWidth = levelSizes[level].x;
+    for (int y = y0 >> level; y <= (y1 >> level); y++) {
+        for (int x = x0 >> level; x <= (x1 >> level); x++) {
+            if (texels[y * levelWidth + x] <= nearestInvW) return true;
+        }
+    }
+    return false;
+}
+
+int OcclusionCuller::removeOccluded(const AABBList& boxes, std::vector<uint32_t>& indices) const {
+    size_t kept = 0;
+    for (uint32_t index : indices) {
+        glm::vec3 minPoint(boxes.minX[index], boxes.minY[index], boxes.minZ[index]);
+        glm::vec3 maxPoint(boxes.maxX[index], boxes.maxY[index], boxes.maxZ[index]);
+        if (isAABBVisible(minPoint, maxPoint)) indices[kept++] = index;
+    }
+    const int removed = static_cast<int>(indices.size() - kept);
+    indices.resize(kept);
+    return removed;
+}
@@ -0,0 +1,77 @@
+#ifndef OCCLUSIONCULLER_H
+#define OCCLUSIONCULLER_H
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+class JobSystem;
+
+// Software occlusion culling. Occluder boxes are rasterized on the CPU into a
+// low resolution depth buffer; boxes are then tested against a pyramid built
+// from it. No GL involved, so it runs (and can be tested) headless.
+//
+// Depth is stored as 1/w (larger = closer, 0 = nothing drawn). Each pyramid
+// texel keeps the minimum of the four below it, i.e. the farthest occluder
+// depth in its area, so a box is hidden when its nearest point is farther than
+// every texel it covers.
+class OcclusionCuller {
+public:
+    // width and height must be multiples of 16
+    explicit OcclusionCuller(int width = 256, int height = 128);
+
+    // Clear the depth buffer and the occluder list
+    void beginFrame(const glm::mat4& viewProjection);
+
+    // Occluders must be fully solid
+    void addOccluder(const glm::vec3& minPoint, const glm::vec3& maxPoint);
+
+    // Rasterize the occluders in row bands, on the job system's workers as
+    // well as the calling thread if one is given, then build the pyramid
+    void rasterize(JobSystem* jobs = nullptr);
+
+    // Test a box against the depth pyramid (call after rasterize)
+    bool isAABBVisible(const glm::vec3& minPoint, const glm::vec3& maxPoint) const;
+
+    // Drop the indices of hidden boxes from the list, returns how many were dropped
+    int removeOccluded(const AABBList& boxes, std::vector<uint32_t>& indices) const;
+
+    // Rows are rasterized 4 pixels at a time with SSE2 where the build has it;
+    // false falls back to the scalar loop (same results, for comparing the two)
+    void setSimd(bool enabled);
+    bool usesSimd() const { return simd; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const std::vector<float>& depthBuffer() const { return levels[0]; }
+
+    // Counters for the last frame
+    int occluderCount() const { return occluders; }
+    int triangleCount() const { return static_cast<int>(triangles.size()); }
+    double rasterizeMs() const { return lastRasterizeMs; }
+
+private:
+    struct ScreenTriangle {
+        float x[3], y[3];  // pixel coordinates, counter-clockwise
+        float invW[3];
+        int minY, maxY;    // rows covered, inclusive
+    };
+
+    void rasterizeBand(int band);
+    void buildPyramid();
+
+    static const int BAND_HEIGHT = 16;
+    static constexpr float NEAR_W = 0.1f; // anything closer is treated as crossing the near plane
+
+    int width, height;
+    glm::mat4 viewProjection;
+    std::vector<ScreenTriangle> triangles;
+    std::vector<std::vector<float>> levels; // levels[0] is the depth buffer
+    std::vector<glm::ivec2> levelSizes;
+    int occluders;
+    double lastRasterizeMs;
+    bool simd;
+};
+
+#endif //OCCLUSIONCULLER_H
@@ -0,0 +1,194 @@
+#include "PaletteStorage.h"
+#include <algorithm>
+
+PaletteStorage::PaletteStorage(int volume, BlockId fillValue)
+    : volume(volume), bits(0), entriesPerWord(0), wordShift(0), indexMask(0), liveEntries(0) {
+    fill(fillValue);
+}
+
+void PaletteStorage::fill(BlockId block) {
+    palette.assign(1, block);
+    refCounts.assign(1, static_cast<uint32_t>(volume));
+    liveEntries = 1;
+    data.clear();
+    data.shrink_to_fit();
+    bits = 0;
+    entriesPerWord = 0;
+    wordShift = 0;
+    indexMask = 0;
+}
+
+bool PaletteStorage::set(int index, BlockId block) {
+    if (bits == 0) {
+        // Uniform fast path: nothing to do if the value doesn't change
+        if (palette[0] == block) return false;
+        resize(1);
+    }
+
+    const uint32_t oldIndex = readIndex(index);
+    if (palette[oldIndex] == block) return false;
+
+    const int newIndex = findOrAddEntry(block);
+    writeIndex(index, static_cast<uint32_t>(newIndex));
+    refCounts[newIndex]++;
+
+    if (--refCounts[oldIndex] == 0) {
+        liveEntries--;
+        // Shrink once the palette fits in half of the next smaller width, so
+        // alternating sets around a threshold don't repack every time
+        if (liveEntries == 1) {
+            resize(0);
+        } else {
+            const int smaller = bits / 2;
+            if (smaller > 0 && liveEntries <= (1 << smaller) / 2) {
+                resize(bitsForEntries(liveEntries));
+            }
+        }
+    }
+    return true;
+}
+
+void PaletteStorage::unpack(BlockId* out) const {
+    if (bits == 0) {
+        for (int i = 0; i < volume; i++) out[i] = palette[0];
+        return;
+    }
+
+    // Walk word by word so each packed word is loaded once
+    int i = 0;
+    for (uint64_t word : data) {
+        for (int e = 0; e < entriesPerWord && i < volume; e++, i++) {
+            out[i] = palette[word & indexMask];
+            word >>= bits;
+        }
+    }
+}
+
+void PaletteStorage::matchMask(BlockId block, uint64_t* out) const {
+    const int words = (volume + 63) / 64;
+    const uint64_t lastWordMask = volume % 64 == 0 ? ~uint64_t(0) : (uint64_t(1) << (volume % 64)) - 1;
+
+    int target = -1;
+    for (int i = 0; i < static_cast<int>(palette.size()); i++) {
+        if (refCounts[i] > 0 && palette[i] == block) target = i;
+    }
+    if (target < 0) {
+        std::fill(out, out + words, 0);
+        return;
+    }
+    if (bits == 0) {
+        std::fill(out, out + words, ~uint64_t(0));
+        out[words - 1] &= lastWordMask;
+        return;
+    }
+    if (bits == 1) {
+        // Entry 1 is the set bits, entry 0 the clear ones
+        const uint64_t flip = target == 0 ? ~uint64_t(0) : 0;
+        for (int w = 0; w < words; w++) out[w] = data[w] ^ flip;
+        out[words - 1] &= lastWordMask;
+        return;
+    }
+
+    std::fill(out, out + words, 0);
+    int i = 0;
+    for (uint64_t word : data) {
+        for (int e = 0; e < entriesPerWord && i < volume; e++, i++) {
+            out[i >> 6] |= static_cast<uint64_t>((word & indexMask) == static_cast<uint64_t>(target)) << (i & 63);
+            word >>= bits;
+        }
+    }
+}
+
+void PaletteStorage::usedBlocks(std::vector<BlockId>& out) const {
+    out.clear();
+    for (size_t i = 0; i < palette.size(); i++) {
+        if (refCounts[i] > 0) out.push_back(palette[i]);
+    }
+}
+
+size_t PaletteStorage::memoryUsage() const {
+    return sizeof(*this)
+         + palette.capacity() * sizeof(BlockId)
+         + refCounts.capacity() * sizeof(uint32_t)
+         + data.capacity() * sizeof(uint64_t);
+}
+
+int PaletteStorage::findOrAddEntry(BlockId block) {
+    // Palettes are small in practice, a linear scan beats hashing here
+    int freeSlot = -1;
+    for (int i = 0; i < static_cast<int>(palette.size()); i++) {
+        if (refCounts[i] == 0) {
+            if (freeSlot < 0) freeSlot = i;
+        } else if (palette[i] == block) {
+            return i;
+        }
+    }
+
+    liveEntries++;
+    if (freeSlot >= 0) {
+        palette[freeSlot] = block;
+        return freeSlot;
+    }
+
+    if (static_cast<int>(palette.size()) == (1 << bits)) {
+        resize(bits * 2);
+    }
+    palette.push_back(block);
+    refCounts.push_back(0);
+    return static_cast<int>(palette.size()) - 1;
+}
+
+// Repack to newBits, compacting the palette down to its live entries
+void PaletteStorage::resize(int newBits) {
+    std::vector<BlockId> newPalette;
+    std::vector<uint32_t> newRefCounts;
+    std::vector<uint32_t> remap(palette.size(), 0);
+    for (size_t i = 0; i < palette.size(); i++) {
+        if (refCounts[i] == 0) continue;
+        remap[i] = static_cast<uint32_t>(newPalette.size());
+        newPalette.push_back(palette[i]);
+        newRefCounts.push_back(refCounts[i]);
+    }
+
+    if (newBits == 0) {
+        fill(newPalette[0]);
+        return;
+    }
+
+    std::vector<uint64_t> newData;
+    const int newEntriesPerWord = 64 / newBits;
+    newData.assign((volume + newEntriesPerWord - 1) / newEntriesPerWord, 0);
+    for (int i = 0; i < volume; i++) {
+        const uint64_t paletteIndex = bits == 0 ? 0 : remap[readIndex(i)];
+        newData[i / newEntriesPerWord] |= paletteIndex << ((i % newEntriesPerWord) * newBits);
+    }
+
+    bits = newBits;
+    entriesPerWord = newEntriesPerWord;
+    wordShift = 0;
+    while ((1 << wordShift) < entriesPerWord) wordShift++;
+    indexMask = (uint64_t(1) << bits) - 1;
+    palette = std::move(newPalette);
+    refCounts = std::move(newRefCounts);
+    data = std::move(newData);
+}
+
+uint32_t PaletteStorage::readIndex(int index) const {
+    const int shift = (index & (entriesPerWord - 1)) * bits;
+    return static_cast<uint32_t>((data[index >> wordShift] >> shift) & indexMask);
+}
+
+void PaletteStorage::writeIndex(int index, uint32_t paletteIndex) {
+    const int shift = (index & (entriesPerWord - 1)) * bits;
+    uint64_t& word = data[index >> wordShift];
+    word = (word & ~(indexMask << shift)) | (uint64_t(paletteIndex) << shift);
+}
+
+int PaletteStorage::bitsForEntries(int entries) {
+    if (entries <= 1) return 0;
+    if (entries <= 2) return 1;
+    if (entries <= 4) return 2;
+    if (entries <= 16) return 4;
+    if (entries <= 256) return 8;
+    return 16;
+}
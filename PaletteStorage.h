@@ -0,0 +1,65 @@
+#ifndef PALETTESTORAGE_H
+#define PALETTESTORAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using BlockId = uint16_t;
+
+// Block storage that keeps a per-chunk palette of the distinct block types and
+// packs palette indices at 1/2/4/8/16 bits per voxel. A uniform chunk keeps no
+// index data at all (0 bits). The width grows and shrinks automatically on set.
+class PaletteStorage {
+public:
+    explicit PaletteStorage(int volume, BlockId fillValue = 0);
+
+    BlockId get(int index) const {
+        if (bits == 0) return palette[0];
+        const int shift = (index & (entriesPerWord - 1)) * bits;
+        const uint64_t paletteIndex = (data[index >> wordShift] >> shift) & indexMask;
+        return palette[paletteIndex];
+    }
+
+    // Returns whether the stored block changed
+    bool set(int index, BlockId block);
+    void fill(BlockId block);
+
+    // Decode every voxel into out[0..volume)
+    void unpack(BlockId* out) const;
+
+    // Bitset of the voxels holding block, bit i % 64 of out[i / 64] for voxel
+    // i, in (volume + 63) / 64 words. At 1 bit per entry that's a copy of the
+    // packed indices.
+    void matchMask(BlockId block, uint64_t* out) const;
+
+    // The distinct blocks stored, in palette order
+    void usedBlocks(std::vector<BlockId>& out) const;
+
+    bool isUniform() const { return bits == 0; }
+    BlockId uniformValue() const { return palette[0]; }
+    int bitsPerEntry() const { return bits; }
+    int paletteSize() const { return liveEntries; }
+    size_t memoryUsage() const;
+
+private:
+    int findOrAddEntry(BlockId block);
+    void resize(int newBits);
+    uint32_t readIndex(int index) const;
+    void writeIndex(int index, uint32_t paletteIndex);
+
+    static int bitsForEntries(int entries);
+
+    int volume;
+    int bits;           // 0, 1, 2, 4, 8 or 16
+    int entriesPerWord; // 64 / bits
+    int wordShift;      // log2(entriesPerWord)
+    uint64_t indexMask;
+    int liveEntries;    // palette entries with refCount > 0
+
+    std::vector<BlockId> palette;
+    std::vector<uint32_t> refCounts; // voxels using each palette entry, 0 = free slot
+    std::vector<uint64_t> data;      // packed palette indices
+};
+
+#endif //PALETTESTORAGE_H
@@ -0,0 +1,265 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "imgui.h"
+
+namespace {
+
+// Slots are written by their thread while the render thread may be reading
+// them, so the fields are relaxed atomics (plain stores on x86). A slot is
+// only trusted when the writer hasn't lapped it by the time it was read.
+struct ZoneSlot {
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> start{0};
+    std::atomic<int64_t> end{0};
+    std::atomic<int> depth{0};
+};
+
+struct ThreadBuffer {
+    std::string name;
+    std::array<ZoneSlot, Profiler::THREAD_EVENTS> slots;
+    std::atomic<uint64_t> written{0};
+    uint64_t read = 0; // render thread only
+};
+
+struct Zone {
+    const char* name;
+    int64_t start, end;
+    int thread;
+    int depth;
+};
+
+struct Frame {
+    int64_t start, end;
+    std::vector<Zone> zones;
+    int dropped; // zones lost to full thread rings
+};
+
+// Buffers outlive their threads, a worker pool restarted later just adds lanes
+std::mutex threadsMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> threads;
+
+thread_local ThreadBuffer* currentBuffer = nullptr;
+thread_local int currentDepth = 0;
+
+// Render thread only
+std::deque<Frame> history;
+std::vector<std::string> threadNames; // copied from the buffers each frame
+int64_t frameStart = 0;
+bool paused = false;
+int selectedFrame = 0; // frames back from the newest
+
+ThreadBuffer& bufferOfThisThread() {
+    if (currentBuffer == nullptr) {
+        auto buffer = std::make_unique<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        buffer->name = "Thread " + std::to_string(threads.size());
+        currentBuffer = buffer.get();
+        threads.push_back(std::move(buffer));
+    }
+    return *currentBuffer;
+}
+
+// Drain a thread's ring into the frame
+void collect(ThreadBuffer& buffer, int threadIndex, Frame& frame) {
+    const uint64_t written = buffer.written.load(std::memory_order_acquire);
+    uint64_t first = buffer.read;
+    if (written - first > Profiler::THREAD_EVENTS) {
+        frame.dropped += static_cast<int>(written - first - Profiler::THREAD_EVENTS);
+        first = written - Profiler::THREAD_EVENTS;
+    }
+
+    const size_t begin = frame.zones.size();
+    for (uint64_t i = first; i < written; i++) {
+        const ZoneSlot& slot = buffer.slots[i % Profiler::THREAD_EVENTS];
+        frame.zones.push_back({slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                               slot.end.load(std::memory_order_relaxed), threadIndex,
+                               slot.depth.load(std::memory_order_relaxed)});
+    }
+
+    // Slots the writer got to again while we were copying are garbage,
+    // including the one it may be writing right now
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t rewritten = buffer.written.load(std::memory_order_relaxed) + 1;
+    if (rewritten - first > Profiler::THREAD_EVENTS) {
+        const uint64_t lost = std::min<uint64_t>(rewritten - first - Profiler::THREAD_EVENTS, written - first);
+        frame.zones.erase(frame.zones.begin() + begin, frame.zones.begin() + begin + lost);
+        frame.dropped += static_cast<int>(lost);
+    }
+    buffer.read = written;
+}
+
+ImU32 colorOf(const char* name) {
+    // Same zone, same color from frame to frame
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c != '\0'; c++) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+    }
+    return IM_COL32(80 + hash % 150, 80 + (hash >> 8) % 150, 80 + (hash >> 16) % 150, 255);
+}
+
+double toMs(int64_t ns) {
+    return static_cast<double>(ns) / 1e6;
+}
+
+}
+
+void Profiler::setThreadName(const char* name) {
+    ThreadBuffer& buffer = bufferOfThisThread();
+    std::lock_guard<std::mutex> lock(threadsMutex);
+    buffer.name = name;
+}
+
+int64_t Profiler::now() {
+    using Clock = std::chrono::steady_clock;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char* name, int64_t start, int64_t end, int depth) {
+    ThreadBuffer& buffer = bufferOfThisThread();
+    const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    ZoneSlot& slot = buffer.slots[index % THREAD_EVENTS];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    slot.depth.store(depth, std::memory_order_relaxed);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+int& Profiler::threadDepth() {
+    return currentDepth;
+}
+
+void Profiler::endFrame() {
+    const int64_t end = now();
+    Frame frame{frameStart, end, {}, 0};
+    frameStart = end;
+
+    {
+        std::lock_guard<std::mutex> lock(threadsMutex);
+        threadNames.resize(threads.size());
+        for (size_t i = 0; i < threads.size(); i++) {
+            threadNames[i] = threads[i]->name;
+            collect(*threads[i], static_cast<int>(i), frame);
+        }
+    }
+
+    // The first frame has no start
+    if (paused || frame.start == 0) return;
+    history.push_back(std::move(frame));
+    if (history.size() > HISTORY) history.pop_front();
+}
+
+void Profiler::drawWindow() {
+    ImGui::SetNextWindowPos(ImVec2(10, 520), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(900, 300), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Profiler");
+#ifndef VOXEL_PROFILER
+    ImGui::Text("Built without VOXEL_PROFILER, no zones are recorded");
+#endif
+    if (history.empty()) {
+        ImGui::End();
+        return;
+    }
+
+    // Frame times, newest on the right
+    float frameMs[HISTORY] = {};
+    const int frameCount = static_cast<int>(history.size());
+    for (int i = 0; i < frameCount; i++) {
+        frameMs[i] = static_cast<float>(toMs(history[i].end - history[i].start));
+    }
+    selectedFrame = std::min(selectedFrame, frameCount - 1);
+    const Frame& frame = history[frameCount - 1 - selectedFrame];
+    const double selectedMs = toMs(frame.end - frame.start);
+
+    ImGui::Checkbox("Pause", &paused);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(200);
+    ImGui::SliderInt("Frames back", &selectedFrame, 0, frameCount - 1);
+    ImGui::SameLine();
+    ImGui::Text("%.2f ms, %zu zones", selectedMs, frame.zones.size());
+    if (frame.dropped > 0) {
+        ImGui::SameLine();
+        ImGui::Text("(%d dropped)", frame.dropped);
+    }
+    ImGui::PlotHistogram("##frames", frameMs, frameCount, 0, nullptr, 0.0f, 33.3f,
+                         ImVec2(ImGui::GetContentRegionAvail().x, 50));
+
+    // One lane per thread, nested zones stacked below their parents
+    std::vector<int> laneDepth(threadNames.size(), -1);
+    for (const Zone& zone : frame.zones) {
+        laneDepth[zone.thread] = std::max(laneDepth[zone.thread], zone.depth);
+    }
+
+    const float labelWidth = 90.0f;
+    const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const float width = std::max(ImGui::GetContentRegionAvail().x - labelWidth, 1.0f);
+    const double nsPerPixel = static_cast<double>(frame.end - frame.start) / width;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    std::vector<float> laneTop(threadNames.size(), 0.0f);
+    float y = origin.y;
+    for (size_t thread = 0; thread < threadNames.size(); thread++) {
+        if (laneDepth[thread] < 0) continue;
+        laneTop[thread] = y;
+        drawList->AddText(ImVec2(origin.x, y + 2.0f), IM_COL32(200, 200, 200, 255), threadNames[thread].c_str());
+        y += (laneDepth[thread] + 1) * rowHeight + 4.0f;
+    }
+
+    // Worker zones can start in the previous frame or end in the next, clip them
+    const ImVec2 timelineMin(origin.x + labelWidth, origin.y);
+    const ImVec2 timelineMax(origin.x + labelWidth + width, y);
+    drawList->PushClipRect(timelineMin, timelineMax, true);
+    const Zone* hovered = nullptr;
+    for (const Zone& zone : frame.zones) {
+        const float x0 = timelineMin.x + static_cast<float>((zone.start - frame.start) / nsPerPixel);
+        const float x1 = timelineMin.x + static_cast<float>((zone.end - frame.start) / nsPerPixel);
+        if (x1 < timelineMin.x || x0 > timelineMax.x) continue;
+
+        const ImVec2 min(x0, laneTop[zone.thread] + zone.depth * rowHeight);
+        const ImVec2 max(std::max(x1, x0 + 1.0f), min.y + rowHeight - 1.0f);
+        drawList->AddRectFilled(min, max, colorOf(zone.name));
+        if (max.x - min.x > ImGui::CalcTextSize(zone.name).x + 4.0f) {
+            drawList->AddText(ImVec2(min.x + 2.0f, min.y + 2.0f), IM_COL32(0, 0, 0, 255), zone.name);
+        }
+        if (ImGui::IsMouseHoveringRect(min, max)) hovered = &zone;
+    }
+    drawList->PopClipRect();
+    ImGui::Dummy(ImVec2(labelWidth + width, y - origin.y));
+    if (hovered != nullptr) {
+        ImGui::SetTooltip("%s\n%.3f ms", hovered->name, toMs(hovered->end - hovered->start));
+    }
+
+    // Totals per zone name over the selected frame
+    struct Total {
+        const char* name;
+        int calls;
+        int64_t ns;
+    };
+    std::vector<Total> totals;
+    for (const Zone& zone : frame.zones) {
+        auto total = std::find_if(totals.begin(), totals.end(),
+                                  [&](const Total& t) { return std::strcmp(t.name, zone.name) == 0; });
+        if (total == totals.end()) {
+            totals.push_back({zone.name, 1, zone.end - zone.start});
+        } else {
+            total->calls++;
+            total->ns += zone.end - zone.start;
+        }
+    }
+    std::sort(totals.begin(), totals.end(), [](const Total& a, const Total& b) { return a.ns > b.ns; });
+    for (const Total& total : totals) {
+        ImGui::Text("%-20s %8.3f ms %5d calls", total.name, toMs(total.ns), total.calls);
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,63 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+
+// Scoped CPU zones, recorded per thread and gathered into a rolling frame
+// history shown by Profiler::drawWindow.
+//
+//     PROFILE_ZONE("Culling"); // times the rest of the enclosing scope
+//
+// Zone names must be string literals, only the pointer is kept. Each thread
+// writes its zones into its own ring without locking, the render thread
+// collects them once per frame in PROFILE_FRAME. Building without
+// VOXEL_PROFILER defined compiles the macros out entirely.
+#ifdef VOXEL_PROFILER
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#define PROFILE_FRAME() Profiler::endFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
+
+class Profiler {
+public:
+    static const int THREAD_EVENTS = 4096; // zones a thread can record between two frames
+    static const int HISTORY = 240;        // frames kept
+
+    // Name shown for the calling thread's lane
+    static void setThreadName(const char* name);
+
+    // Render thread: close the current frame and collect every thread's zones
+    static void endFrame();
+
+    // ImGui window with the frame times and a timeline of one frame
+    static void drawWindow();
+
+    static int64_t now(); // nanoseconds
+    static void record(const char* name, int64_t start, int64_t end, int depth);
+    static int& threadDepth();
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) : name(name), depth(Profiler::threadDepth()++), start(Profiler::now()) {}
+    ~ProfileZone() {
+        Profiler::threadDepth()--;
+        Profiler::record(name, start, Profiler::now(), depth);
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name;
+    int depth;
+    int64_t start;
+};
+
+#endif //PROFILER_H
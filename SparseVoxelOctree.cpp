@@ -0,0 +1,193 @@
+#include "SparseVoxelOctree.h"
+
+SparseVoxelOctree::SparseVoxelOctree(int size, BlockId fill)
+    : size(size) {
+    nodes.push_back({NO_CHILDREN, fill});
+}
+
+SparseVoxelOctree SparseVoxelOctree::fromChunk(const Chunk& chunk) {
+    int treeSize = 1;
+    while (treeSize < CHUNK_SIZE) treeSize *= 2;
+
+    std::vector<BlockId> dense(CHUNK_VOLUME);
+    chunk.blocks.unpack(dense.data());
+
+    SparseVoxelOctree tree(treeSize);
+    tree.buildNode(0, dense.data(), CHUNK_SIZE, glm::ivec3(0), treeSize);
+    return tree;
+}
+
+void SparseVoxelOctree::toChunk(Chunk& chunk) const {
+    chunk.blocks.fill(BLOCK_AIR);
+    forEachLeaf(glm::ivec3(0), glm::ivec3(CHUNK_SIZE), [&](const glm::ivec3& leafMin, int leafSize, BlockId block) {
+        if (block == BLOCK_AIR) return;
+        const glm::ivec3 end = glm::min(leafMin + leafSize, glm::ivec3(CHUNK_SIZE));
+        for (int y = leafMin.y; y < end.y; y++) {
+            for (int x = leafMin.x; x < end.x; x++) {
+                for (int z = leafMin.z; z < end.z; z++) {
+                    chunk.blocks.set(Chunk::index(x, y, z), block);
+                }
+            }
+        }
+    });
+    chunk.dirty = true;
+}
+
+BlockId SparseVoxelOctree::get(int x, int y, int z) const {
+    if (x < 0 || y < 0 || z < 0 || x >= size || y >= size || z >= size) return BLOCK_AIR;
+
+    uint32_t node = 0;
+    int half = size / 2;
+    while (nodes[node].firstChild != NO_CHILDREN) {
+        const int dx = x >= half ? 1 : 0;
+        const int dy = y >= half ? 1 : 0;
+        const int dz = z >= half ? 1 : 0;
+        x -= dx * half;
+        y -= dy * half;
+        z -= dz * half;
+        node = nodes[node].firstChild + childIndex(dx, dy, dz);
+        half /= 2;
+    }
+    return nodes[node].block;
+}
+
+void SparseVoxelOctree::set(int x, int y, int z, BlockId block) {
+    if (x < 0 || y < 0 || z < 0 || x >= size || y >= size || z >= size) return;
+    setNode(0, glm::ivec3(0), size, glm::ivec3(x, y, z), block);
+}
+
+bool SparseVoxelOctree::isBoxEmpty(const glm::ivec3& minCorner, const glm::ivec3& maxCorner) const {
+    bool empty = true;
+    forEachLeaf(minCorner, maxCorner, [&](const glm::ivec3&, int, BlockId block) {
+        if (block != BLOCK_AIR) empty = false;
+    });
+    return empty;
+}
+
+void SparseVoxelOctree::forEachLeaf(const glm::ivec3& minCorner, const glm::ivec3& maxCorner,
+                                    const std::function<void(const glm::ivec3&, int, BlockId)>& visit) const {
+    visitNode(0, glm::ivec3(0), size, minCorner, maxCorner, visit);
+}
+
+size_t SparseVoxelOctree::memoryUsage() const {
+    return sizeof(*this) + nodes.capacity() * sizeof(Node) + freeBlocks.capacity() * sizeof(uint32_t);
+}
+
+uint32_t SparseVoxelOctree::allocateChildren(BlockId fill) {
+    uint32_t first;
+    if (!freeBlocks.empty()) {
+        first = freeBlocks.back();
+        freeBlocks.pop_back();
+    } else {
+        first = static_cast<uint32_t>(nodes.size());
+        nodes.resize(nodes.size() + 8);
+    }
+    for (int i = 0; i < 8; i++) {
+        nodes[first + i] = {NO_CHILDREN, fill};
+    }
+    return first;
+}
+
+void SparseVoxelOctree::releaseChildren(uint32_t firstChild) {
+    for (int i = 0; i < 8; i++) {
+        if (nodes[firstChild + i].firstChild != NO_CHILDREN) {
+            releaseChildren(nodes[firstChild + i].firstChild);
+        }
+    }
+    freeBlocks.push_back(firstChild);
+}
+
+// Bottom-up build: children are built first and only kept if they differ
+void SparseVoxelOctree::buildNode(uint32_t node, const BlockId* dense, int denseSize, const glm::ivec3& origin, int nodeSize) {
+    if (nodeSize == 1) {
+        const bool inside = origin.x < denseSize && origin.y < denseSize && origin.z < denseSize;
+        nodes[node].block = inside ? dense[Chunk::index(origin.x, origin.y, origin.z)] : BLOCK_AIR;
+        return;
+    }
+
+    // Entirely outside the dense data: one air leaf
+    if (origin.x >= denseSize || origin.y >= denseSize || origin.z >= denseSize) {
+        nodes[node].block = BLOCK_AIR;
+        return;
+    }
+
+    const uint32_t first = allocateChildren(BLOCK_AIR);
+    nodes[node].firstChild = first;
+    const int half = nodeSize / 2;
+    for (int dx = 0; dx < 2; dx++) {
+        for (int dy = 0; dy < 2; dy++) {
+            for (int dz = 0; dz < 2; dz++) {
+                buildNode(first + childIndex(dx, dy, dz), dense, denseSize,
+                          origin + glm::ivec3(dx, dy, dz) * half, half);
+            }
+        }
+    }
+    tryCollapse(node);
+}
+
+// Returns true if the node ended up as a leaf
+bool SparseVoxelOctree::setNode(uint32_t node, const glm::ivec3& origin, int nodeSize, const glm::ivec3& p, BlockId block) {
+    if (nodes[node].firstChild == NO_CHILDREN) {
+        if (nodes[node].block == block) return true;
+        if (nodeSize == 1) {
+            nodes[node].block = block;
+            return true;
+        }
+        // Split the leaf, every child inherits its value
+        const uint32_t first = allocateChildren(nodes[node].block);
+        nodes[node].firstChild = first;
+    }
+
+    const int half = nodeSize / 2;
+    const int dx = p.x >= origin.x + half ? 1 : 0;
+    const int dy = p.y >= origin.y + half ? 1 : 0;
+    const int dz = p.z >= origin.z + half ? 1 : 0;
+    const uint32_t child = nodes[node].firstChild + childIndex(dx, dy, dz);
+    if (setNode(child, origin + glm::ivec3(dx, dy, dz) * half, half, p, block)) {
+        return tryCollapse(node);
+    }
+    return false;
+}
+
+// Merge 8 leaf children holding the same block into their parent
+bool SparseVoxelOctree::tryCollapse(uint32_t node) {
+    const uint32_t first = nodes[node].firstChild;
+    if (first == NO_CHILDREN) return true;
+
+    const BlockId block = nodes[first].block;
+    for (int i = 0; i < 8; i++) {
+        const Node& child = nodes[first + i];
+        if (child.firstChild != NO_CHILDREN || child.block != block) return false;
+    }
+
+    releaseChildren(first);
+    nodes[node].firstChild = NO_CHILDREN;
+    nodes[node].block = block;
+    return true;
+}
+
+void SparseVoxelOctree::visitNode(uint32_t node, const glm::ivec3& origin, int nodeSize,
+                                  const glm::ivec3& minCorner, const glm::ivec3& maxCorner,
+                                  const std::function<void(const glm::ivec3&, int, BlockId)>& visit) const {
+    // Skip nodes that don't overlap the query box
+    if (origin.x >= maxCorner.x || origin.y >= maxCorner.y || origin.z >= maxCorner.z ||
+        origin.x + nodeSize <= minCorner.x || origin.y + nodeSize <= minCorner.y || origin.z + nodeSize <= minCorner.z) {
+        return;
+    }
+
+    const Node& n = nodes[node];
+    if (n.firstChild == NO_CHILDREN) {
+        visit(origin, nodeSize, n.block);
+        return;
+    }
+
+    const int half = nodeSize / 2;
+    for (int dx = 0; dx < 2; dx++) {
+        for (int dy = 0; dy < 2; dy++) {
+            for (int dz = 0; dz < 2; dz++) {
+                visitNode(n.firstChild + childIndex(dx, dy, dz), origin + glm::ivec3(dx, dy, dz) * half, half,
+                          minCorner, maxCorner, visit);
+            }
+        }
+    }
+}
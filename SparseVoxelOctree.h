@@ -0,0 +1,61 @@
+#ifndef SPARSEVOXELOCTREE_H
+#define SPARSEVOXELOCTREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Chunk.h"
+
+// Sparse voxel octree over a cube of size^3 voxels (size is a power of two).
+// Nodes live in one contiguous pool; the 8 children of a node are stored as
+// consecutive entries and referenced by the index of the first one. Whenever
+// all 8 children end up as leaves of the same block they collapse back into
+// their parent, so a homogeneous region costs a single node.
+class SparseVoxelOctree {
+public:
+    explicit SparseVoxelOctree(int size, BlockId fill = BLOCK_AIR);
+
+    // Build from / export to a dense chunk (voxels outside the chunk are air)
+    static SparseVoxelOctree fromChunk(const Chunk& chunk);
+    void toChunk(Chunk& chunk) const;
+
+    // Point queries, coordinates are local to the tree
+    BlockId get(int x, int y, int z) const;
+    void set(int x, int y, int z, BlockId block);
+
+    // Box queries over [minCorner, maxCorner) in local voxel coordinates
+    bool isBoxEmpty(const glm::ivec3& minCorner, const glm::ivec3& maxCorner) const;
+    void forEachLeaf(const glm::ivec3& minCorner, const glm::ivec3& maxCorner,
+                     const std::function<void(const glm::ivec3& leafMin, int leafSize, BlockId block)>& visit) const;
+
+    int getSize() const { return size; }
+    size_t nodeCount() const { return nodes.size() - freeBlocks.size() * 8; }
+    size_t memoryUsage() const;
+
+private:
+    static const uint32_t NO_CHILDREN = 0xFFFFFFFFu;
+
+    struct Node {
+        uint32_t firstChild; // index of the first of 8 consecutive children, NO_CHILDREN for a leaf
+        BlockId block;       // value of a leaf
+    };
+
+    uint32_t allocateChildren(BlockId fill);
+    void releaseChildren(uint32_t firstChild);
+    void buildNode(uint32_t node, const BlockId* dense, int denseSize, const glm::ivec3& origin, int nodeSize);
+    bool setNode(uint32_t node, const glm::ivec3& origin, int nodeSize, const glm::ivec3& p, BlockId block);
+    bool tryCollapse(uint32_t node);
+    void visitNode(uint32_t node, const glm::ivec3& origin, int nodeSize,
+                   const glm::ivec3& minCorner, const glm::ivec3& maxCorner,
+                   const std::function<void(const glm::ivec3&, int, BlockId)>& visit) const;
+
+    static int childIndex(int dx, int dy, int dz) { return (dx << 2) | (dy << 1) | dz; }
+
+    int size;
+    std::vector<Node> nodes;          // nodes[0] is the root
+    std::vector<uint32_t> freeBlocks; // first index of released 8-node blocks
+};
+
+#endif //SPARSEVOXELOCTREE_H
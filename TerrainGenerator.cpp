@@ -0,0 +1,40 @@
+#include "TerrainGenerator.h"
+#include <algorithm>
+#include <cmath>
+
+int terrainHeight(int x, int z) {
+    // A few overlapping waves give rolling hills without a noise library
+    const float h = 3.0f * std::sin(x * 0.11f) * std::cos(z * 0.09f)
+                  + 2.0f * std::sin((x + z) * 0.05f)
+                  + 1.5f * std::cos(x * 0.23f - z * 0.17f);
+    return static_cast<int>(std::floor(h));
+}
+
+template <int Size>
+void generateChunk(BasicChunk<Size>& chunk) {
+    // Quick out for chunks entirely above or below the surface range
+    if (chunk.y > 7) {
+        chunk.blocks.fill(BLOCK_AIR);
+        chunk.dirty = true;
+        return;
+    }
+    if (chunk.y + Size <= -7) {
+        chunk.blocks.fill(BLOCK_STONE);
+        chunk.dirty = true;
+        return;
+    }
+
+    for (int x = 0; x < Size; x++) {
+        for (int z = 0; z < Size; z++) {
+            // Stone up to the surface, the rest stays air
+            const int top = std::min(Size, terrainHeight(chunk.x + x, chunk.z + z) - chunk.y + 1);
+            for (int y = 0; y < top; y++) {
+                chunk.set(x, y, z, BLOCK_STONE);
+            }
+        }
+    }
+    chunk.dirty = true;
+}
+
+#define INSTANTIATE_GENERATE_CHUNK(size) template void generateChunk<size>(BasicChunk<size>&);
+FOR_EACH_CHUNK_SIZE(INSTANTIATE_GENERATE_CHUNK)
@@ -0,0 +1,14 @@
+#ifndef TERRAINGENERATOR_H
+#define TERRAINGENERATOR_H
+
+#include "Chunk.h"
+
+// Height of the terrain surface at world column (x, z)
+int terrainHeight(int x, int z);
+
+// Fill a chunk from the deterministic terrain function (compiled for the
+// sizes in FOR_EACH_CHUNK_SIZE)
+template <int Size>
+void generateChunk(BasicChunk<Size>& chunk);
+
+#endif //TERRAINGENERATOR_H
@@ -0,0 +1,137 @@
+#include "UploadRing.h"
+#include <glad/glad.h>
+
+UploadRing::UploadRing(size_t regionBytes)
+    : regionBytes(regionBytes), persistent(GLAD_GL_VERSION_4_4 != 0), buffer(0), memory(nullptr), current(0),
+      failedReservations(0), bytesCopiedThisFrame(0), lastBytesCopied(0), lastFailedReservations(0) {
+    const size_t totalBytes = regionBytes * REGIONS;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    if (persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_READ_BUFFER, totalBytes, nullptr, flags);
+        memory = static_cast<char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, totalBytes, flags));
+    } else {
+        glBufferData(GL_COPY_READ_BUFFER, totalBytes, nullptr, GL_STREAM_DRAW);
+        memory = new char[totalBytes];
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+UploadRing::~UploadRing() {
+    // GL objects go in cleanup(), while the context is still current
+    if (!persistent) delete[] memory;
+}
+
+UploadSpan UploadRing::reserve(size_t bytes) {
+    // Keep spans 16 byte aligned for the copies
+    const size_t alignedBytes = (bytes + 15) & ~static_cast<size_t>(15);
+
+    if (bytes == 0) return UploadSpan();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    Region& region = regions[current];
+    if (memory == nullptr || region.head + alignedBytes > regionBytes) {
+        failedReservations++;
+        return UploadSpan();
+    }
+
+    UploadSpan span;
+    span.offset = static_cast<size_t>(current) * regionBytes + region.head;
+    span.data = memory + span.offset;
+    span.size = bytes;
+    span.region = current;
+    region.head += alignedBytes;
+    region.pending++;
+    return span;
+}
+
+void UploadRing::copyTo(UploadSpan& span, unsigned int dstBuffer, size_t dstOffset) {
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    if (!persistent) {
+        glBufferSubData(GL_COPY_READ_BUFFER, span.offset, span.size, span.data);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, dstBuffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, span.offset, dstOffset, span.size);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    bytesCopiedThisFrame += span.size;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        regions[span.region].copied = true;
+    }
+    release(span);
+}
+
+void UploadRing::release(UploadSpan& span) {
+    if (span.data == nullptr) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        regions[span.region].pending--;
+    }
+    span = UploadSpan();
+}
+
+void UploadRing::endFrame() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (memory == nullptr) return;
+
+    if (persistent) {
+        for (Region& region : regions) {
+            if (!region.copied) continue;
+            if (region.fence != nullptr) glDeleteSync(static_cast<GLsync>(region.fence));
+            region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            region.copied = false;
+        }
+    } else {
+        // Copies are issued right after their glBufferSubData, so nothing in
+        // the buffer is needed any more: orphan it instead of syncing
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBufferData(GL_COPY_READ_BUFFER, regionBytes * REGIONS, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    }
+
+    // Spans still waiting to be copied pin their region, keep filling the
+    // current one until the next is free
+    const int next = (current + 1) % REGIONS;
+    if (regions[current].head > 0 && regionFree(regions[next])) {
+        regions[next].head = 0;
+        current = next;
+    }
+
+    lastBytesCopied = bytesCopiedThisFrame;
+    lastFailedReservations = failedReservations;
+    bytesCopiedThisFrame = 0;
+    failedReservations = 0;
+}
+
+void UploadRing::cleanup() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Region& region : regions) {
+        if (region.fence != nullptr) glDeleteSync(static_cast<GLsync>(region.fence));
+        region = Region();
+    }
+    if (persistent && memory != nullptr) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    } else {
+        delete[] memory;
+    }
+    memory = nullptr;
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+bool UploadRing::regionFree(Region& region) {
+    if (region.pending > 0) return false;
+    if (region.fence == nullptr) return true;
+
+    // Don't wait, just poll
+    const GLenum status = glClientWaitSync(static_cast<GLsync>(region.fence), 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+    glDeleteSync(static_cast<GLsync>(region.fence));
+    region.fence = nullptr;
+    return true;
+}
@@ -0,0 +1,88 @@
+#ifndef UPLOADRING_H
+#define UPLOADRING_H
+
+#include <cstddef>
+#include <mutex>
+
+// Bytes reserved in an UploadRing. data is null when the reservation failed.
+struct UploadSpan {
+    char* data = nullptr;
+    size_t offset = 0; // in the ring's GL buffer
+    size_t size = 0;
+    int region = -1;
+};
+
+// Streaming upload buffer split into REGIONS regions, one filled per frame.
+// Any thread can reserve() space and write into it, the render thread then
+// copies the data where it belongs with glCopyBufferSubData, so the GL thread
+// never stalls on a glBufferData reallocation.
+//
+// With GL 4.4 the buffer is created with glBufferStorage and stays mapped
+// (persistent + coherent), writers fill GPU visible memory directly and a
+// fence per region keeps a region from being rewritten while copies out of it
+// are still queued on the GPU. On older contexts writers fill a CPU staging
+// copy instead, and each span is pushed with glBufferSubData right before its
+// copy, into storage orphaned once per frame.
+//
+// reserve() never waits: when the current region is full, or the next one is
+// still in use, it fails and callers upload the old way.
+class UploadRing {
+public:
+    static const int REGIONS = 3;
+
+    // Needs a current GL context
+    explicit UploadRing(size_t regionBytes);
+    ~UploadRing();
+
+    UploadRing(const UploadRing&) = delete;
+    UploadRing& operator=(const UploadRing&) = delete;
+
+    // Any thread. The span stays valid until it is copied or released.
+    UploadSpan reserve(size_t bytes);
+
+    // Render thread: copy a span into dstBuffer and release it
+    void copyTo(UploadSpan& span, unsigned int dstBuffer, size_t dstOffset);
+    // Render thread: give up a span without copying it
+    void release(UploadSpan& span);
+
+    // Render thread, once per frame after the copies: fence this frame's
+    // copies and move on to the next region if it is free
+    void endFrame();
+
+    // Unmap and delete the buffer, reserve() fails afterwards. Writers must be
+    // done (stop the job system first).
+    void cleanup();
+
+    bool isPersistent() const { return persistent; }
+    size_t regionSize() const { return regionBytes; }
+
+    // Stats for the last finished frame
+    size_t bytesCopied() const { return lastBytesCopied; }
+    int missedReservations() const { return lastFailedReservations; }
+
+private:
+    struct Region {
+        size_t head = 0;     // bytes reserved
+        int pending = 0;     // spans not yet copied or released
+        bool copied = false; // copies out of it were issued this frame
+        void* fence = nullptr;
+    };
+
+    bool regionFree(Region& region);
+
+    size_t regionBytes;
+    bool persistent;
+    unsigned int buffer;
+    char* memory; // mapped buffer or CPU staging copy, REGIONS * regionBytes
+
+    std::mutex mutex; // guards the regions and current
+    Region regions[REGIONS];
+    int current;
+    int failedReservations;
+
+    size_t bytesCopiedThisFrame;
+    size_t lastBytesCopied;
+    int lastFailedReservations;
+};
+
+#endif //UPLOADRING_H
@@ -0,0 +1,232 @@
+#include "World.h"
+#include <algorithm>
+#include <cmath>
+#include "ChunkVisibility.h"
+#include "Profiler.h"
+
+namespace {
+
+// Face neighbour offsets in ChunkNeighbours order: -X, +X, -Y, +Y, -Z, +Z
+const glm::ivec3 neighbourOffsets[6] = {
+    {-1, 0, 0}, {1, 0, 0},
+    {0, -1, 0}, {0, 1, 0},
+    {0, 0, -1}, {0, 0, 1},
+};
+
+}
+
+World::World(int loadRadius, int unloadRadius, int verticalRadius, unsigned int workerThreads)
+    : loadRadius(loadRadius), unloadRadius(std::max(unloadRadius, loadRadius + 1)), verticalRadius(verticalRadius),
+      maxUnloadsPerFrame(8), uploadBudgetMs(2.0), jobs(workerThreads), pipeline(jobs), centerChunk(0),
+      hasCenter(false), meshingMode(MeshingMode::Greedy), lodDistances{4, 7, 10}, visibilityStamp(0), loading(0), meshing(0), uploads(0) {}
+
+World::~World() {
+    // Workers must be gone before the pipeline and the chunks they reference
+    jobs.shutdown();
+    clear();
+}
+
+void World::update(const glm::vec3& cameraPos) {
+    PROFILE_ZONE("World Update");
+    const glm::ivec3 center = chunkCoordOf(cameraPos);
+    if (!hasCenter || center != centerChunk) {
+        centerChunk = center;
+        hasCenter = true;
+        scheduleAround(center);
+    }
+
+    for (int i = 0; i < maxUnloadsPerFrame && !unloadQueue.empty(); i++) {
+        const glm::ivec3 coord = unloadQueue.front();
+        unloadQueue.pop_front();
+        // The camera may have come back since this was queued
+        if (!inRadius(coord, centerChunk, unloadRadius)) {
+            unloadChunk(coord);
+        }
+    }
+
+    // Newly generated chunks need a mesh, and so do their neighbours' borders
+    for (const auto& chunk : pipeline.takeGenerated()) {
+        if (chunk->cancelled.load()) continue;
+        chunk->dirty = true;
+        markNeighboursDirty(chunkCoordOf(glm::vec3(chunk->x, chunk->y, chunk->z)));
+    }
+
+    scheduleMeshes();
+    uploads = pipeline.uploadReady(uploadBudgetMs, renderPool);
+}
+
+void World::findVisibleChunks(const glm::vec3& cameraPos, const Frustum& frustum, std::vector<Chunk*>& visible) {
+    PROFILE_ZONE("Connectivity Culling");
+    findReachableChunks(chunks, chunkCoordOf(cameraPos), frustum, ++visibilityStamp, visible);
+}
+
+ChunkNeighbours World::getNeighbours(const glm::ivec3& coord) const {
+    ChunkNeighbours neighbours{};
+    for (int i = 0; i < 6; i++) {
+        neighbours[i] = chunks.find(coord + neighbourOffsets[i]);
+    }
+    return neighbours;
+}
+
+void World::setMeshingMode(MeshingMode mode) {
+    if (mode == meshingMode) return;
+    meshingMode = mode;
+    markAllDirty();
+}
+
+void World::setLodDistances(const std::array<int, MAX_CHUNK_LOD>& distances) {
+    lodDistances = distances;
+    if (hasCenter) updateLods();
+}
+
+std::array<int, MAX_CHUNK_LOD> World::lodRingsFromVoxels(const std::array<int, MAX_CHUNK_LOD>& voxels) {
+    std::array<int, MAX_CHUNK_LOD> rings{};
+    int previous = 0;
+    for (int lod = 0; lod < MAX_CHUNK_LOD; lod++) {
+        rings[lod] = std::max(previous + 1, (voxels[lod] + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        previous = rings[lod];
+    }
+    return rings;
+}
+
+void World::markAllDirty() {
+    forEachChunk([](const glm::ivec3&, Chunk& chunk) {
+        chunk.dirty = true;
+    });
+}
+
+void World::clear() {
+    chunks.forEach([](const glm::ivec3&, Chunk& chunk) {
+        chunk.cancelled = true;
+        chunk.renderSlot = -1;
+    });
+    chunks.clear();
+    renderPool.clear();
+    unloadQueue.clear();
+    hasCenter = false;
+    loading = 0;
+    meshing = 0;
+}
+
+glm::ivec3 World::chunkCoordOf(const glm::vec3& worldPos) {
+    // Voxels are centered on integer positions, so chunk c spans
+    // [c * CHUNK_SIZE - 0.5, (c + 1) * CHUNK_SIZE - 0.5)
+    return glm::ivec3(glm::floor((worldPos + 0.5f) / static_cast<float>(CHUNK_SIZE)));
+}
+
+void World::scheduleAround(const glm::ivec3& center) {
+    // Create everything missing inside the load radius; the job priority
+    // (distance to the camera) makes the workers generate nearest first
+    for (int dy = -verticalRadius; dy <= verticalRadius; dy++) {
+        for (int dx = -loadRadius; dx <= loadRadius; dx++) {
+            for (int dz = -loadRadius; dz <= loadRadius; dz++) {
+                const glm::ivec3 coord = center + glm::ivec3(dx, dy, dz);
+                if (!inRadius(coord, center, loadRadius) || chunks.find(coord) != nullptr) continue;
+
+                auto chunk = std::make_shared<Chunk>(coord.x * CHUNK_SIZE, coord.y * CHUNK_SIZE, coord.z * CHUNK_SIZE);
+                chunk->lod = lodOf(coord);
+                chunk->renderSlot = renderPool.acquire();
+                chunks.insert(coord, chunk);
+                pipeline.generate(chunk, priorityOf(coord));
+            }
+        }
+    }
+
+    updateLods();
+
+    // Everything resident beyond the unload radius
+    unloadQueue.clear();
+    chunks.forEach([&](const glm::ivec3& coord, Chunk&) {
+        if (!inRadius(coord, center, unloadRadius)) {
+            unloadQueue.push_back(coord);
+        }
+    });
+}
+
+void World::unloadChunk(const glm::ivec3& coord) {
+    std::shared_ptr<Chunk> chunk = chunks.erase(coord);
+    if (!chunk) return;
+
+    // Pending generate/mesh jobs for it are skipped from now on
+    chunk->cancelled = true;
+    renderPool.release(chunk->renderSlot);
+    chunk->renderSlot = -1;
+    markNeighboursDirty(coord);
+}
+
+void World::scheduleMeshes() {
+    meshing = 0;
+    loading = 0;
+    chunks.forEach([&](const glm::ivec3& coord, Chunk& chunk) {
+        if (!chunk.generated.load(std::memory_order_acquire)) {
+            loading++;
+            return;
+        }
+        if (!chunk.dirty) return;
+
+        // Wait until every neighbour that will exist has been generated, so the
+        // border isn't meshed twice
+        std::array<std::shared_ptr<Chunk>, 6> neighbours;
+        for (int i = 0; i < 6; i++) {
+            neighbours[i] = chunks.findShared(coord + neighbourOffsets[i]);
+            if (neighbours[i] && !neighbours[i]->generated.load(std::memory_order_acquire)) return;
+        }
+
+        // Neighbours at another level of detail count as empty space (see buildLodMesh)
+        const int lod = meshingMode == MeshingMode::OctreeLeaves ? 0 : chunk.lod;
+        for (auto& neighbour : neighbours) {
+            if (neighbour && neighbour->lod != chunk.lod) neighbour.reset();
+        }
+
+        chunk.dirty = false;
+        chunk.meshVersion++;
+        pipeline.mesh(chunks.findShared(coord), neighbours, meshingMode, lod, priorityOf(coord));
+        meshing++;
+    });
+}
+
+// Border faces of the neighbours depend on this chunk
+void World::markNeighboursDirty(const glm::ivec3& coord) {
+    for (const glm::ivec3& offset : neighbourOffsets) {
+        Chunk* neighbour = chunks.find(coord + offset);
+        // Chunks still generating get meshed once they finish anyway
+        if (neighbour != nullptr && neighbour->generated.load(std::memory_order_acquire)) {
+            neighbour->dirty = true;
+        }
+    }
+}
+
+// Move chunks whose distance ring changed to their new level of detail
+void World::updateLods() {
+    chunks.forEach([&](const glm::ivec3& coord, Chunk& chunk) {
+        const int lod = lodOf(coord);
+        if (lod == chunk.lod) return;
+        chunk.lod = lod;
+
+        // The neighbours' border faces depend on whether they share the level
+        if (chunk.generated.load(std::memory_order_acquire)) chunk.dirty = true;
+        markNeighboursDirty(coord);
+    });
+}
+
+int World::lodOf(const glm::ivec3& coord) const {
+    const int dx = coord.x - centerChunk.x;
+    const int dz = coord.z - centerChunk.z;
+    const int distanceSq = dx * dx + dz * dz;
+    int lod = 0;
+    while (lod < MAX_CHUNK_LOD && distanceSq >= lodDistances[lod] * lodDistances[lod]) {
+        lod++;
+    }
+    return lod;
+}
+
+bool World::inRadius(const glm::ivec3& coord, const glm::ivec3& center, int radius) const {
+    const int dx = coord.x - center.x;
+    const int dz = coord.z - center.z;
+    return dx * dx + dz * dz <= radius * radius && std::abs(coord.y - center.y) <= verticalRadius;
+}
+
+int World::priorityOf(const glm::ivec3& coord) const {
+    const glm::ivec3 d = coord - centerChunk;
+    return d.x * d.x + d.y * d.y + d.z * d.z;
+}
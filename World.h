@@ -0,0 +1,109 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <glm/glm.hpp>
+#include "ChunkMap.h"
+#include "ChunkMesher.h"
+#include "ChunkPipeline.h"
+#include "ChunkRenderPool.h"
+#include "Frustum.h"
+#include "JobSystem.h"
+
+// Keeps the chunks around the camera resident. Chunks within loadRadius (in
+// chunks, horizontally) are created and handed to the job system for
+// generation, nearest first; chunks beyond unloadRadius are queued for
+// unloading and their pending jobs cancelled. The gap between the two radii
+// keeps chunks at the edge from flickering in and out. Meshing also runs on
+// the workers, the render thread only uploads finished meshes under a time
+// budget, so frame time stays flat while the camera moves.
+//
+// Chunks at least lodDistances[i] chunks away (horizontally) are meshed at
+// level of detail i + 1, see buildLodMesh.
+class World {
+public:
+    World(int loadRadius, int unloadRadius, int verticalRadius = 1, unsigned int workerThreads = 0);
+    ~World();
+
+    // Call once per frame from the GL thread
+    void update(const glm::vec3& cameraPos);
+
+    Chunk* getChunk(const glm::ivec3& coord) const { return chunks.find(coord); }
+    // GPU side of a resident chunk (its mesh and cube instances)
+    ChunkRenderData& renderData(const Chunk& chunk) { return renderPool[chunk.renderSlot]; }
+    ChunkNeighbours getNeighbours(const glm::ivec3& coord) const;
+    void setMeshingMode(MeshingMode mode);
+    // Finished meshes are written into the ring by the workers (see ChunkPipeline)
+    void setUploadRing(UploadRing* ring) { pipeline.setUploadRing(ring); }
+    void markAllDirty();
+
+    // Chunk distances where each coarser level of detail starts, increasing.
+    // Remeshes the chunks that change level.
+    void setLodDistances(const std::array<int, MAX_CHUNK_LOD>& distances);
+    const std::array<int, MAX_CHUNK_LOD>& getLodDistances() const { return lodDistances; }
+    // LOD distances given in voxels as chunk rings: rounded up, the camera's
+    // own chunk always at full detail and every ring past the previous one
+    static std::array<int, MAX_CHUNK_LOD> lodRingsFromVoxels(const std::array<int, MAX_CHUNK_LOD>& voxels);
+
+    // Release every chunk and its GL resources
+    void clear();
+
+    // Visits generated chunks only
+    template <typename Fn>
+    void forEachChunk(Fn&& fn) const {
+        chunks.forEach([&](const glm::ivec3& coord, Chunk& chunk) {
+            if (chunk.generated.load(std::memory_order_acquire)) fn(coord, chunk);
+        });
+    }
+
+    // Generated chunks that can be seen from the camera's chunk through air,
+    // inside the frustum (see findReachableChunks)
+    void findVisibleChunks(const glm::vec3& cameraPos, const Frustum& frustum, std::vector<Chunk*>& visible);
+
+    static glm::ivec3 chunkCoordOf(const glm::vec3& worldPos);
+
+    // Settings
+    int loadRadius;
+    int unloadRadius;
+    int verticalRadius;
+    int maxUnloadsPerFrame;
+    double uploadBudgetMs;
+
+    // Stats
+    int residentCount() const { return static_cast<int>(chunks.size()); }
+    int loadingCount() const { return loading; }
+    int unloadingCount() const { return static_cast<int>(unloadQueue.size()); }
+    int meshingCount() const { return meshing; }
+    int uploadsLastFrame() const { return uploads; }
+    JobSystem& jobSystem() { return jobs; }
+    const JobSystem& jobSystem() const { return jobs; }
+
+private:
+    void scheduleAround(const glm::ivec3& center);
+    void unloadChunk(const glm::ivec3& coord);
+    void scheduleMeshes();
+    void markNeighboursDirty(const glm::ivec3& coord);
+    void updateLods();
+    int lodOf(const glm::ivec3& coord) const;
+    bool inRadius(const glm::ivec3& coord, const glm::ivec3& center, int radius) const;
+    int priorityOf(const glm::ivec3& coord) const;
+
+    JobSystem jobs;
+    ChunkPipeline pipeline;
+    ChunkMap chunks;
+    ChunkRenderPool renderPool;
+    std::deque<glm::ivec3> unloadQueue;
+    glm::ivec3 centerChunk;
+    bool hasCenter;
+    MeshingMode meshingMode;
+    std::array<int, MAX_CHUNK_LOD> lodDistances;
+    unsigned int visibilityStamp;
+
+    int loading;  // resident, generation not finished
+    int meshing;  // mesh jobs scheduled this frame
+    int uploads;  // meshes uploaded this frame
+};
+
+#endif //WORLD_H
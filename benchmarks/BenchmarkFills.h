@@ -0,0 +1,53 @@
+#ifndef BENCHMARKFILLS_H
+#define BENCHMARKFILLS_H
+
+#include <cstdint>
+#include "../Chunk.h"
+
+// Deterministic chunk contents shared by the benchmarks
+enum class ChunkFill {
+    Solid,        // every voxel set
+    Noise,        // ~50% of voxels set, fixed seed
+    Checkerboard, // alternating voxels, worst case for every mesher
+    Count
+};
+
+inline const char* chunkFillName(ChunkFill fill) {
+    switch (fill) {
+        case ChunkFill::Solid: return "solid";
+        case ChunkFill::Noise: return "noise";
+        case ChunkFill::Checkerboard: return "checkerboard";
+        default: return "unknown";
+    }
+}
+
+// Cheap integer hash, stable across platforms
+inline uint32_t hashVoxel(int x, int y, int z) {
+    uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^ static_cast<uint32_t>(z) * 83492791u;
+    h ^= h >> 13;
+    h *= 0x5bd1e995u;
+    h ^= h >> 15;
+    return h;
+}
+
+inline bool fillContains(ChunkFill fill, int x, int y, int z) {
+    switch (fill) {
+        case ChunkFill::Solid: return true;
+        case ChunkFill::Noise: return (hashVoxel(x, y, z) & 1u) != 0;
+        case ChunkFill::Checkerboard: return ((x + y + z) & 1) == 0;
+        default: return false;
+    }
+}
+
+template <int Size>
+void fillChunk(BasicChunk<Size>& chunk, ChunkFill fill) {
+    for (int y = 0; y < Size; y++) {
+        for (int x = 0; x < Size; x++) {
+            for (int z = 0; z < Size; z++) {
+                chunk.set(x, y, z, fillContains(fill, x, y, z) ? BLOCK_STONE : BLOCK_AIR);
+            }
+        }
+    }
+}
+
+#endif //BENCHMARKFILLS_H
@@ -0,0 +1,21 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "../Cube.h"
+
+// Model matrices of a batch of rotated cubes, as the cube paths rebuild them
+static void BM_UpdateModelMatrix(benchmark::State& state) {
+    std::vector<Cube> cubes;
+    for (int i = 0; i < state.range(0); i++) {
+        cubes.emplace_back(glm::vec3(i, i % 7, -i), glm::vec3(0.0f, 1.0f, 0.0f), static_cast<float>(i % 360), glm::vec3(1.0f));
+    }
+    for (auto _ : state) {
+        for (Cube& cube : cubes) {
+            cube.rotationAngle += 1.0f;
+            cube.updateModelMatrix();
+        }
+        benchmark::DoNotOptimize(cubes.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(cubes.size()));
+}
+
+BENCHMARK(BM_UpdateModelMatrix)->Name("Cube/UpdateModelMatrix")->RangeMultiplier(8)->Range(64, 4096);
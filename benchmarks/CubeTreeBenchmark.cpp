@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include "../CubeHandler.h"
+#include "../CubeHandlerArena.h"
+
+// Build and tear down a buildTestCubeTree of the given depth, nodes from new/delete
+static void BM_CubeTreeNewDelete(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    size_t nodes = 0;
+    for (auto _ : state) {
+        auto* root = new CubeHandler(Cube(), 1.0f);
+        buildTestCubeTree(*root, depth);
+        benchmark::DoNotOptimize(root);
+        delete root;
+    }
+    // 8 children per split, 4 of them split again
+    for (int d = 0, splits = 1; d < depth; d++, splits *= 4) nodes += splits * 8;
+    state.counters["nodes"] = static_cast<double>(nodes);
+}
+
+// Same tree, nodes from the arena and released in bulk
+static void BM_CubeTreeArena(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    CubeHandlerArena arena;
+    for (auto _ : state) {
+        CubeHandler root(Cube(), 1.0f);
+        buildTestCubeTree(root, depth, &arena);
+        benchmark::DoNotOptimize(&root);
+        arena.clear();
+    }
+    // Counters from one more build so they reflect a live tree
+    CubeHandler root(Cube(), 1.0f);
+    buildTestCubeTree(root, depth, &arena);
+    state.counters["nodes"] = static_cast<double>(arena.liveNodes());
+    state.counters["bytes"] = static_cast<double>(arena.bytesInUse());
+}
+
+// Arena, but tearing the tree down subtree by subtree
+static void BM_CubeTreeArenaRelease(benchmark::State& state) {
+    const int depth = static_cast<int>(state.range(0));
+    CubeHandlerArena arena;
+    for (auto _ : state) {
+        CubeHandler root(Cube(), 1.0f);
+        buildTestCubeTree(root, depth, &arena);
+        benchmark::DoNotOptimize(&root);
+        arena.releaseChildren(root);
+    }
+}
+
+// A single splitCube, children from the arena
+static void BM_SplitCube(benchmark::State& state) {
+    CubeHandlerArena arena;
+    for (auto _ : state) {
+        CubeHandler root(Cube(), 1.0f);
+        splitCube(root, &arena);
+        benchmark::DoNotOptimize(root.children.data());
+        arena.clear();
+    }
+}
+
+BENCHMARK(BM_SplitCube)->Name("CubeTree/Split");
+BENCHMARK(BM_CubeTreeNewDelete)->Name("CubeTree/NewDelete")->DenseRange(4, 8)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CubeTreeArena)->Name("CubeTree/Arena")->DenseRange(4, 8)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CubeTreeArenaRelease)->Name("CubeTree/ArenaRelease")->DenseRange(4, 8)->Unit(benchmark::kMicrosecond);
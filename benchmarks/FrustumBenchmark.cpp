@@ -0,0 +1,102 @@
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+#include "../Frustum.h"
+
+// Chunk-sized boxes scattered around a camera at the origin, roughly half of
+// them end up inside the frustum
+static AABBList makeBoxes(size_t count) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-200.0f, 200.0f);
+    AABBList boxes;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 minPoint(coord(rng), coord(rng) * 0.25f, coord(rng));
+        boxes.add(minPoint, minPoint + glm::vec3(10.0f));
+    }
+    return boxes;
+}
+
+static Frustum makeFrustum() {
+    glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum;
+    frustum.update(projection * view, 0.9f);
+    return frustum;
+}
+
+static void BM_FrustumUpdate(benchmark::State& state) {
+    glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, 300.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 viewProjection = projection * view;
+    Frustum frustum;
+    for (auto _ : state) {
+        frustum.update(viewProjection, 0.9f);
+        benchmark::DoNotOptimize(&frustum);
+    }
+}
+
+static void BM_PointTest(benchmark::State& state) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-200.0f, 200.0f);
+    std::vector<glm::vec3> points(static_cast<size_t>(state.range(0)));
+    for (glm::vec3& point : points) {
+        point = glm::vec3(coord(rng), coord(rng) * 0.25f, coord(rng));
+    }
+    const Frustum frustum = makeFrustum();
+    for (auto _ : state) {
+        int inside = 0;
+        for (const glm::vec3& point : points) {
+            inside += frustum.isPointInFrustum(point) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(inside);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(points.size()));
+}
+
+// One isAABBInFrustum call per box
+static void BM_CullScalar(benchmark::State& state) {
+    const AABBList boxes = makeBoxes(static_cast<size_t>(state.range(0)));
+    const Frustum frustum = makeFrustum();
+    std::vector<uint32_t> visible;
+    for (auto _ : state) {
+        visible.clear();
+        for (size_t i = 0; i < boxes.size(); ++i) {
+            glm::vec3 minPoint(boxes.minX[i], boxes.minY[i], boxes.minZ[i]);
+            glm::vec3 maxPoint(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]);
+            if (frustum.isAABBInFrustum(minPoint, maxPoint)) visible.push_back(static_cast<uint32_t>(i));
+        }
+        benchmark::DoNotOptimize(visible.data());
+    }
+    state.counters["visible"] = static_cast<double>(visible.size());
+    state.counters["boxes/s"] = benchmark::Counter(static_cast<double>(state.iterations() * boxes.size()), benchmark::Counter::kIsRate);
+}
+
+static void BM_CullMask(benchmark::State& state) {
+    const AABBList boxes = makeBoxes(static_cast<size_t>(state.range(0)));
+    const Frustum frustum = makeFrustum();
+    std::vector<uint32_t> bits;
+    for (auto _ : state) {
+        frustum.cullAABBMask(boxes, bits);
+        benchmark::DoNotOptimize(bits.data());
+    }
+    state.counters["boxes/s"] = benchmark::Counter(static_cast<double>(state.iterations() * boxes.size()), benchmark::Counter::kIsRate);
+}
+
+static void BM_CullIndices(benchmark::State& state) {
+    const AABBList boxes = makeBoxes(static_cast<size_t>(state.range(0)));
+    const Frustum frustum = makeFrustum();
+    std::vector<uint32_t> visible;
+    for (auto _ : state) {
+        frustum.cullAABBIndices(boxes, visible);
+        benchmark::DoNotOptimize(visible.data());
+    }
+    state.counters["visible"] = static_cast<double>(visible.size());
+    state.counters["boxes/s"] = benchmark::Counter(static_cast<double>(state.iterations() * boxes.size()), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(BM_FrustumUpdate)->Name("Frustum/Update");
+BENCHMARK(BM_PointTest)->Name("Frustum/Point")->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(BM_CullScalar)->Name("Frustum/Scalar")->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(BM_CullMask)->Name("Frustum/BatchMask")->RangeMultiplier(8)->Range(64, 32768);
+BENCHMARK(BM_CullIndices)->Name("Frustum/BatchIndices")->RangeMultiplier(8)->Range(64, 32768);
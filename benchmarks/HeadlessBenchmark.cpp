@@ -0,0 +1,470 @@
+// Headless regression benchmark: flies a fixed camera spline over the
+// generated terrain in a surfaceless EGL context (Mesa's llvmpipe works, no
+// display or GPU needed) and records per-frame timings and counts.
+//
+//   VoxelHeadlessBenchmark [--frames N] [--width W] [--height H] [--async]
+//                          [--csv frames.csv] [--json frames.json]
+//
+// By default every frame waits until the chunks around the camera are
+// generated, meshed and uploaded, so the counts are the same from run to run
+// and only the timings move. --async streams like the interactive build
+// instead (counts then depend on how fast the workers are).
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include "../ChunkMesh.h"
+#include "../ChunkMesher.h"
+#include "../ClipmapTerrain.h"
+#include "../Frustum.h"
+#include "../GpuTimers.h"
+#include "../MeshPool.h"
+#include "../OcclusionCuller.h"
+#include "../TerrainGenerator.h"
+#include "../UploadRing.h"
+#include "../World.h"
+
+namespace {
+
+struct Options {
+    int frames = 600;
+    int width = 1200;
+    int height = 800;
+    bool async = false;
+    std::string csvPath;
+    std::string jsonPath;
+};
+
+struct FrameRecord {
+    double cpuMs;    // whole frame
+    double worldMs;  // World and far terrain update (including the wait unless --async)
+    double cullMs;   // connectivity, frustum and occlusion culling
+    double renderMs; // queueing and submitting the draws
+    double gpuMs;    // chunk pass on the GPU
+    double finishMs; // waiting in glFinish (where llvmpipe does its rasterizing)
+    int drawCalls;
+    int triangles;
+    int residentChunks;
+    int consideredChunks; // reachable through air (connectivity culling)
+    int frustumCulled;
+    int occlusionCulled;
+    int drawnChunks;
+};
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--frames" && hasValue) {
+            options.frames = std::max(2, std::atoi(argv[++i]));
+        } else if (arg == "--width" && hasValue) {
+            options.width = std::max(16, std::atoi(argv[++i]));
+        } else if (arg == "--height" && hasValue) {
+            options.height = std::max(16, std::atoi(argv[++i]));
+        } else if (arg == "--async") {
+            options.async = true;
+        } else if (arg == "--csv" && hasValue) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--frames N] [--width W] [--height H] [--async] [--csv file] [--json file]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Surfaceless context, 4.3 core for multi-draw indirect, 3.3 core otherwise
+bool createContext(EGLDisplay& display, EGLContext& context) {
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    display = getPlatformDisplay != nullptr
+        ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+        : EGL_NO_DISPLAY;
+    if (display == EGL_NO_DISPLAY) display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "Failed to initialize EGL" << std::endl;
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL has no desktop OpenGL" << std::endl;
+        return false;
+    }
+
+    // We render into our own framebuffer, so no config is needed where
+    // EGL_KHR_no_config_context is there (the surfaceless platform has no configs)
+    const EGLint configAttributes[] = {EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE};
+    EGLConfig config = EGL_NO_CONFIG_KHR;
+    EGLint configCount = 0;
+    const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+    const bool noConfig = extensions != nullptr && std::strstr(extensions, "EGL_KHR_no_config_context") != nullptr;
+    if (!noConfig && (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)) {
+        std::cerr << "No EGL config for OpenGL" << std::endl;
+        return false;
+    }
+
+    context = EGL_NO_CONTEXT;
+    for (EGLint version : {43, 33}) {
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version / 10,
+            EGL_CONTEXT_MINOR_VERSION, version % 10,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context != EGL_NO_CONTEXT) break;
+    }
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "Failed to create a surfaceless OpenGL 3.3 context" << std::endl;
+        return false;
+    }
+    return gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress)) != 0;
+}
+
+unsigned int compileShader(const char* path, GLenum type) {
+    std::ifstream file(path);
+    std::stringstream source;
+    source << file.rdbuf();
+    const std::string code = source.str();
+    const char* text = code.c_str();
+
+    const unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &text, nullptr);
+    glCompileShader(shader);
+    int success;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        char infoLog[512];
+        glGetShaderInfoLog(shader, 512, nullptr, infoLog);
+        std::cerr << path << ": " << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+unsigned int createProgram() {
+    const unsigned int vertexShader = compileShader(SHADER_DIR "/vertex_shader.glsl", GL_VERTEX_SHADER);
+    const unsigned int fragmentShader = compileShader(SHADER_DIR "/fragment_shader.glsl", GL_FRAGMENT_SHADER);
+    if (vertexShader == 0 || fragmentShader == 0) return 0;
+
+    const unsigned int program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+// Closed Catmull-Rom loop through points a fixed height over the terrain
+class CameraPath {
+public:
+    CameraPath() {
+        const glm::vec2 columns[] = {{0, 0}, {160, -90}, {340, 40}, {420, 260}, {250, 430}, {40, 360}, {-60, 170}};
+        for (const glm::vec2& column : columns) {
+            const int ground = terrainHeight(static_cast<int>(column.x), static_cast<int>(column.y));
+            points.emplace_back(column.x, static_cast<float>(ground + 24), column.y);
+        }
+    }
+
+    // t in [0, 1] over the whole loop
+    glm::vec3 position(float t) const { return evaluate(t, false); }
+    glm::vec3 direction(float t) const { return glm::normalize(evaluate(t, true)); }
+
+private:
+    glm::vec3 evaluate(float t, bool derivative) const {
+        const int count = static_cast<int>(points.size());
+        const float scaled = t * count;
+        const int segment = std::min(static_cast<int>(scaled), count - 1);
+        const float u = scaled - segment;
+        const glm::vec3& p0 = points[(segment + count - 1) % count];
+        const glm::vec3& p1 = points[segment];
+        const glm::vec3& p2 = points[(segment + 1) % count];
+        const glm::vec3& p3 = points[(segment + 2) % count];
+        if (derivative) {
+            return 0.5f * ((p2 - p0) + 2.0f * u * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3)
+                           + 3.0f * u * u * (-p0 + 3.0f * p1 - 3.0f * p2 + p3));
+        }
+        return 0.5f * (2.0f * p1 + u * (p2 - p0) + u * u * (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3)
+                       + u * u * u * (-p0 + 3.0f * p1 - 3.0f * p2 + p3));
+    }
+
+    std::vector<glm::vec3> points;
+};
+
+// Generate, mesh and upload everything the camera position asks for
+void settle(World& world, const glm::vec3& cameraPos) {
+    do {
+        world.jobSystem().waitIdle();
+        world.update(cameraPos);
+    } while (world.loadingCount() > 0 || world.meshingCount() > 0 || world.uploadsLastFrame() > 0
+             || world.unloadingCount() > 0);
+}
+
+double percentile(std::vector<double> values, double p) {
+    std::sort(values.begin(), values.end());
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(p * (values.size() - 1) + 0.5));
+    return values[index];
+}
+
+void writeCsv(const std::string& path, const std::vector<FrameRecord>& records) {
+    std::ofstream out(path);
+    out << "frame,cpu_ms,world_ms,cull_ms,render_ms,gpu_ms,finish_ms,draw_calls,triangles,"
+           "resident_chunks,considered_chunks,frustum_culled,occlusion_culled,drawn_chunks\n";
+    for (size_t i = 0; i < records.size(); i++) {
+        const FrameRecord& r = records[i];
+        out << i << ',' << r.cpuMs << ',' << r.worldMs << ',' << r.cullMs << ',' << r.renderMs << ',' << r.gpuMs << ','
+            << r.finishMs << ',' << r.drawCalls << ',' << r.triangles << ',' << r.residentChunks << ','
+            << r.consideredChunks << ',' << r.frustumCulled << ',' << r.occlusionCulled << ',' << r.drawnChunks << '\n';
+    }
+}
+
+// A JSON string literal, quotes included
+std::string jsonString(const char* text) {
+    std::string quoted = "\"";
+    for (const char* c = text; *c != '\0'; c++) {
+        const unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '"' || ch == '\\') {
+            quoted += '\\';
+            quoted += *c;
+        } else if (ch < 0x20) {
+            char escaped[7];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+            quoted += escaped;
+        } else {
+            quoted += *c;
+        }
+    }
+    return quoted + '"';
+}
+
+void writeJson(const std::string& path, const Options& options, const char* renderer,
+               const std::vector<FrameRecord>& records) {
+    std::vector<double> cpu, gpu;
+    for (const FrameRecord& r : records) {
+        cpu.push_back(r.cpuMs);
+        gpu.push_back(r.gpuMs);
+    }
+
+    std::ofstream out(path);
+    out << "{\n  \"renderer\": " << jsonString(renderer) << ",\n"
+        << "  \"width\": " << options.width << ", \"height\": " << options.height
+        << ", \"async\": " << (options.async ? "true" : "false") << ",\n"
+        << "  \"summary\": {\"cpu_ms_p50\": " << percentile(cpu, 0.5) << ", \"cpu_ms_p95\": " << percentile(cpu, 0.95)
+        << ", \"gpu_ms_p50\": " << percentile(gpu, 0.5) << ", \"gpu_ms_p95\": " << percentile(gpu, 0.95) << "},\n"
+        << "  \"frames\": [\n";
+    for (size_t i = 0; i < records.size(); i++) {
+        const FrameRecord& r = records[i];
+        out << "    {\"cpu_ms\": " << r.cpuMs << ", \"world_ms\": " << r.worldMs << ", \"cull_ms\": " << r.cullMs
+            << ", \"render_ms\": " << r.renderMs << ", \"gpu_ms\": " << r.gpuMs << ", \"finish_ms\": " << r.finishMs
+            << ", \"draw_calls\": " << r.drawCalls
+            << ", \"triangles\": " << r.triangles << ", \"resident_chunks\": " << r.residentChunks
+            << ", \"considered_chunks\": " << r.consideredChunks << ", \"frustum_culled\": " << r.frustumCulled
+            << ", \"occlusion_culled\": " << r.occlusionCulled << ", \"drawn_chunks\": " << r.drawnChunks << "}"
+            << (i + 1 < records.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 1;
+
+    EGLDisplay display;
+    EGLContext context;
+    if (!createContext(display, context)) return 1;
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    std::cout << "Renderer: " << renderer << " (" << glGetString(GL_VERSION) << ")" << std::endl;
+
+    const unsigned int shaderProgram = createProgram();
+    if (shaderProgram == 0) {
+        std::cerr << "Failed to build the shader program" << std::endl;
+        return 1;
+    }
+
+    // No default framebuffer without a surface
+    unsigned int framebuffer, colorBuffer, depthBuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glGenRenderbuffers(1, &colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, options.width, options.height);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    glViewport(0, 0, options.width, options.height);
+    glEnable(GL_DEPTH_TEST);
+
+    ChunkMesh::initSharedBuffers(MAX_CHUNK_QUADS);
+    glUseProgram(shaderProgram);
+    MeshPool::originsLoc = glGetUniformLocation(shaderProgram, "chunkOrigins");
+    MeshPool::packedLoc = glGetUniformLocation(shaderProgram, "packedVertex");
+    MeshPool::pageShiftLoc = glGetUniformLocation(shaderProgram, "pageShift");
+    const int viewLoc = glGetUniformLocation(shaderProgram, "view");
+    const int projLoc = glGetUniformLocation(shaderProgram, "projection");
+
+    // Same setup as the interactive build (binary greedy meshes, LOD rings, far terrain,
+    // connectivity and occlusion culling)
+    UploadRing uploadRing(4 * 1024 * 1024);
+    World world(144 / CHUNK_SIZE, 160 / CHUNK_SIZE, std::max(1, 24 / CHUNK_SIZE));
+    world.setMeshingMode(MeshingMode::BinaryGreedy);
+    world.setLodDistances(World::lodRingsFromVoxels({40, 70, 100}));
+    world.setUploadRing(&uploadRing);
+    if (!options.async) {
+        world.uploadBudgetMs = 1e9;
+        world.maxUnloadsPerFrame = 1 << 20;
+    }
+    ClipmapTerrain clipmap(4, 8);
+    OcclusionCuller occlusion;
+    Frustum frustum;
+    GpuTimers gpuTimers({"Chunks"});
+
+    const CameraPath path;
+    const glm::mat4 projection = glm::perspective(glm::radians(90.0f),
+                                                  static_cast<float>(options.width) / options.height, 0.1f, 3000.0f);
+
+    // Start with the first camera position loaded either way
+    settle(world, path.position(0.0f));
+
+    std::vector<Chunk*> frameChunks;
+    AABBList chunkBounds;
+    std::vector<uint32_t> visibleChunks;
+    std::vector<FrameRecord> records;
+    records.reserve(options.frames);
+
+    using Clock = std::chrono::steady_clock;
+    for (int frame = 0; frame < options.frames; frame++) {
+        const auto frameStart = Clock::now();
+        FrameRecord record{};
+
+        const float t = static_cast<float>(frame) / options.frames;
+        const glm::vec3 cameraPos = path.position(t);
+        const glm::vec3 cameraFront = glm::normalize(path.direction(t) + glm::vec3(0.0f, -0.35f, 0.0f));
+        const glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, glm::vec3(0.0f, 1.0f, 0.0f));
+        frustum.update(projection * view, 0.9f);
+
+        auto start = Clock::now();
+        if (options.async) {
+            world.update(cameraPos);
+        } else {
+            settle(world, cameraPos);
+        }
+        clipmap.update(cameraPos, World::chunkCoordOf(cameraPos), world.loadRadius, world.verticalRadius);
+        record.worldMs = msSince(start);
+
+        start = Clock::now();
+        frameChunks.clear();
+        world.findVisibleChunks(cameraPos, frustum, frameChunks);
+        chunkBounds.clear();
+        for (const Chunk* chunk : frameChunks) {
+            const glm::vec3 origin(chunk->x, chunk->y, chunk->z);
+            chunkBounds.add(origin - 0.5f, origin + (CHUNK_SIZE - 0.5f));
+        }
+        frustum.cullAABBIndices(chunkBounds, visibleChunks);
+        record.consideredChunks = static_cast<int>(frameChunks.size());
+        record.frustumCulled = record.consideredChunks - static_cast<int>(visibleChunks.size());
+
+        occlusion.beginFrame(projection * view);
+        for (uint32_t index : visibleChunks) {
+            const Chunk& chunk = *frameChunks[index];
+            if (chunk.occluderEnd <= chunk.occluderBegin) continue;
+            const glm::vec3 origin(chunk.x, chunk.y, chunk.z);
+            occlusion.addOccluder(origin + glm::vec3(-0.5f, chunk.occluderBegin - 0.5f, -0.5f),
+                                  origin + glm::vec3(CHUNK_SIZE - 0.5f, chunk.occluderEnd - 0.5f, CHUNK_SIZE - 0.5f));
+        }
+        occlusion.rasterize(&world.jobSystem());
+        record.occlusionCulled = occlusion.removeOccluded(chunkBounds, visibleChunks);
+        record.cullMs = msSince(start);
+
+        start = Clock::now();
+        gpuTimers.beginFrame();
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glUseProgram(shaderProgram);
+        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+
+        gpuTimers.begin(0);
+        for (uint32_t index : visibleChunks) {
+            const ChunkMesh& mesh = world.renderData(*frameChunks[index]).mesh;
+            mesh.queueDraw();
+            record.triangles += mesh.triangleCount();
+        }
+        clipmap.queueVisible(frustum);
+        record.triangles += clipmap.trianglesQueued();
+        record.drawCalls = ChunkMesh::drawQueued(shaderProgram);
+        gpuTimers.end(0, record.triangles, record.drawCalls);
+        record.renderMs = msSince(start);
+
+        // Stand-in for the swap: keeps the GPU in step and makes this
+        // frame's query readable now
+        start = Clock::now();
+        glFinish();
+        record.finishMs = msSince(start);
+        gpuTimers.collect();
+        record.gpuMs = gpuTimers.passes()[0].gpuMs;
+
+        record.residentChunks = world.residentCount();
+        record.drawnChunks = static_cast<int>(visibleChunks.size());
+        record.cpuMs = msSince(frameStart);
+        records.push_back(record);
+    }
+
+    std::vector<double> cpu, gpu;
+    for (const FrameRecord& r : records) {
+        cpu.push_back(r.cpuMs);
+        gpu.push_back(r.gpuMs);
+    }
+    std::printf("%d frames: CPU p50 %.2f ms, p95 %.2f ms; GPU p50 %.2f ms, p95 %.2f ms\n", options.frames,
+                percentile(cpu, 0.5), percentile(cpu, 0.95), percentile(gpu, 0.5), percentile(gpu, 0.95));
+    if (!options.csvPath.empty()) writeCsv(options.csvPath, records);
+    if (!options.jsonPath.empty()) writeJson(options.jsonPath, options, renderer, records);
+
+    // Workers may still be writing into the upload ring
+    world.jobSystem().shutdown();
+    world.clear();
+    uploadRing.cleanup();
+    clipmap.cleanup();
+    gpuTimers.cleanup();
+    ChunkMesh::cleanupSharedBuffers();
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteProgram(shaderProgram);
+
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    eglDestroyContext(display, context);
+    eglTerminate(display);
+    return 0;
+}
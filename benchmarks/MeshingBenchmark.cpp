@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include "BenchmarkFills.h"
+#include "../ChunkMesher.h"
+
+template <int Lod>
+static void buildLodMeshAt(const Chunk& chunk, const ChunkNeighbours& neighbours, std::vector<ChunkVertex>& vertices) {
+    buildLodMesh(chunk, neighbours, Lod, vertices);
+}
+
+// Time per iteration is the time to mesh one chunk; "quads" is the mesh size.
+// Items are voxels, so chunk sizes compare per voxel.
+template <int Size, void (*Mesher)(const BasicChunk<Size>&, const BasicChunkNeighbours<Size>&, std::vector<ChunkVertex>&)>
+static void BM_MeshChunk(benchmark::State& state) {
+    const ChunkFill fill = static_cast<ChunkFill>(state.range(0));
+    BasicChunk<Size> chunk(0, 0, 0);
+    fillChunk(chunk, fill);
+
+    std::vector<ChunkVertex> vertices;
+    for (auto _ : state) {
+        Mesher(chunk, BasicChunkNeighbours<Size>{}, vertices);
+        benchmark::DoNotOptimize(vertices.data());
+    }
+
+    state.SetLabel(chunkFillName(fill));
+    state.counters["chunk_size"] = Size;
+    state.counters["quads"] = static_cast<double>(meshQuadCount(vertices));
+    state.counters["chunks/s"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    state.SetItemsProcessed(state.iterations() * BasicChunk<Size>::VOLUME);
+}
+
+#define MESH_BENCHMARKS(size) \
+    BENCHMARK(BM_MeshChunk<size, buildCulledMesh<size>>)->Name("Mesh/Culled/" + std::to_string(size))->DenseRange(0, static_cast<int>(ChunkFill::Count) - 1); \
+    BENCHMARK(BM_MeshChunk<size, buildGreedyMesh<size>>)->Name("Mesh/Greedy/" + std::to_string(size))->DenseRange(0, static_cast<int>(ChunkFill::Count) - 1); \
+    BENCHMARK(BM_MeshChunk<size, buildBinaryGreedyMesh<size>>)->Name("Mesh/BinaryGreedy/" + std::to_string(size))->DenseRange(0, static_cast<int>(ChunkFill::Count) - 1);
+FOR_EACH_CHUNK_SIZE(MESH_BENCHMARKS)
+
+// LOD meshing only exists for the engine's chunk size
+BENCHMARK(BM_MeshChunk<CHUNK_SIZE, buildLodMeshAt<1>>)->Name("Mesh/Lod1")->DenseRange(0, static_cast<int>(ChunkFill::Count) - 1);
+BENCHMARK(BM_MeshChunk<CHUNK_SIZE, buildLodMeshAt<2>>)->Name("Mesh/Lod2")->DenseRange(0, static_cast<int>(ChunkFill::Count) - 1);
+BENCHMARK(BM_MeshChunk<CHUNK_SIZE, buildLodMeshAt<3>>)->Name("Mesh/Lod3")->DenseRange(0, static_cast<int>(ChunkFill::Count) - 1);
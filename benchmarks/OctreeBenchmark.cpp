@@ -0,0 +1,25 @@
+#include <benchmark/benchmark.h>
+#include "BenchmarkFills.h"
+#include "../SparseVoxelOctree.h"
+
+// Compress a chunk into an octree
+static void BM_OctreeFromChunk(benchmark::State& state) {
+    const ChunkFill fill = static_cast<ChunkFill>(state.range(0));
+    Chunk chunk(0, 0, 0);
+    fillChunk(chunk, fill);
+
+    size_t nodes = 0, bytes = 0;
+    for (auto _ : state) {
+        SparseVoxelOctree octree = SparseVoxelOctree::fromChunk(chunk);
+        nodes = octree.nodeCount();
+        bytes = octree.memoryUsage();
+        benchmark::DoNotOptimize(&octree);
+    }
+    state.SetLabel(chunkFillName(fill));
+    state.counters["chunk_size"] = CHUNK_SIZE;
+    state.counters["nodes"] = static_cast<double>(nodes);
+    state.counters["bytes"] = static_cast<double>(bytes);
+    state.SetItemsProcessed(state.iterations() * CHUNK_VOLUME);
+}
+
+BENCHMARK(BM_OctreeFromChunk)->Name("Octree/FromChunk")->DenseRange(0, static_cast<int>(ChunkFill::Count) - 1);
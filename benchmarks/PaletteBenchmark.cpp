@@ -0,0 +1,72 @@
+#include <benchmark/benchmark.h>
+#include <vector>
+#include "BenchmarkFills.h"
+#include "../PaletteStorage.h"
+
+// Fill storage with exactly enough distinct blocks to land on the requested width
+static PaletteStorage makeStorage(int bits, std::vector<BlockId>& used) {
+    const int distinct = bits == 0 ? 1 : (bits == 16 ? 512 : 1 << bits);
+    PaletteStorage storage(CHUNK_VOLUME);
+    used.clear();
+    for (int i = 0; i < CHUNK_VOLUME; i++) {
+        const BlockId block = static_cast<BlockId>(i % distinct);
+        storage.set(i, block);
+    }
+    for (int i = 0; i < distinct; i++) {
+        used.push_back(static_cast<BlockId>(i));
+    }
+    return storage;
+}
+
+static void BM_PaletteGet(benchmark::State& state) {
+    std::vector<BlockId> used;
+    const PaletteStorage storage = makeStorage(static_cast<int>(state.range(0)), used);
+
+    for (auto _ : state) {
+        uint32_t sum = 0;
+        for (int i = 0; i < CHUNK_VOLUME; i++) {
+            sum += storage.get(static_cast<int>(hashVoxel(i, 0, 0) % CHUNK_VOLUME));
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.counters["bits"] = storage.bitsPerEntry();
+    state.counters["bytes"] = static_cast<double>(storage.memoryUsage());
+    state.SetItemsProcessed(state.iterations() * CHUNK_VOLUME);
+}
+
+// Sets only use blocks already in the palette, so the width stays fixed
+static void BM_PaletteSet(benchmark::State& state) {
+    std::vector<BlockId> used;
+    PaletteStorage storage = makeStorage(static_cast<int>(state.range(0)), used);
+
+    uint32_t n = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < CHUNK_VOLUME; i++, n++) {
+            storage.set(static_cast<int>(hashVoxel(n, 1, 0) % CHUNK_VOLUME), used[n % used.size()]);
+        }
+        benchmark::ClobberMemory();
+    }
+
+    state.counters["bits"] = storage.bitsPerEntry();
+    state.counters["bytes"] = static_cast<double>(storage.memoryUsage());
+    state.SetItemsProcessed(state.iterations() * CHUNK_VOLUME);
+}
+
+static void BM_PaletteUnpack(benchmark::State& state) {
+    std::vector<BlockId> used;
+    const PaletteStorage storage = makeStorage(static_cast<int>(state.range(0)), used);
+    std::vector<BlockId> out(CHUNK_VOLUME);
+
+    for (auto _ : state) {
+        storage.unpack(out.data());
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.counters["bits"] = storage.bitsPerEntry();
+    state.SetItemsProcessed(state.iterations() * CHUNK_VOLUME);
+}
+
+BENCHMARK(BM_PaletteGet)->Name("Palette/Get")->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16);
+BENCHMARK(BM_PaletteSet)->Name("Palette/Set")->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16);
+BENCHMARK(BM_PaletteUnpack)->Name("Palette/Unpack")->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->Arg(16);
@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "../TerrainGenerator.h"
+
+// Chunk heights relative to the terrain: the sky and deep rock take the
+// quick fill, surface chunks sample terrainHeight per column
+enum class ChunkLayer { Sky, Surface, Deep, Count };
+
+static const char* chunkLayerName(ChunkLayer layer) {
+    switch (layer) {
+        case ChunkLayer::Sky: return "sky";
+        case ChunkLayer::Surface: return "surface";
+        case ChunkLayer::Deep: return "deep";
+        default: return "unknown";
+    }
+}
+
+static int chunkLayerY(ChunkLayer layer, int size) {
+    switch (layer) {
+        case ChunkLayer::Sky: return 4 * size;
+        case ChunkLayer::Deep: return -4 * size;
+        default: return -size / 2;
+    }
+}
+
+// Time per iteration is one chunk; the column moves so every chunk is different
+template <int Size>
+static void BM_GenerateChunk(benchmark::State& state) {
+    const ChunkLayer layer = static_cast<ChunkLayer>(state.range(0));
+    const int y = chunkLayerY(layer, Size);
+    int column = 0;
+    for (auto _ : state) {
+        BasicChunk<Size> chunk(column * Size, y, (column / 64) * Size);
+        generateChunk(chunk);
+        benchmark::DoNotOptimize(&chunk);
+        column = (column + 1) % 4096;
+    }
+    state.SetLabel(chunkLayerName(layer));
+    state.counters["chunk_size"] = Size;
+    state.SetItemsProcessed(state.iterations() * BasicChunk<Size>::VOLUME);
+}
+
+#define TERRAIN_BENCHMARKS(size) \
+    BENCHMARK(BM_GenerateChunk<size>)->Name("Terrain/GenerateChunk/" + std::to_string(size))->DenseRange(0, static_cast<int>(ChunkLayer::Count) - 1);
+FOR_EACH_CHUNK_SIZE(TERRAIN_BENCHMARKS)
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <any>
 #include <filesystem>
 #include <fstream>
@@ -11,15 +12,27 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Cube.h"
+#include "Chunk.h"
+#include "CubeHandler.h"
+#include "CubeHandlerArena.h"
+#include "CubeInstanceBuffer.h"
+#include "ChunkMesher.h"
+#include "TerrainGenerator.h"
+#include "World.h"
+#include "ClipmapTerrain.h"
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include <array>
 #include "Frustum.h"
+#include "GpuTimers.h"
+#include "OcclusionCuller.h"
+#include "Profiler.h"
 
 // Function prototypes
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xposIn, double yposIn);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void processInput(GLFWwindow *window);
 unsigned int compileShader(const char* shaderSource, GLenum shaderType);
 std::string readShaderFile(const char* filePath);
@@ -27,7 +40,7 @@ std::string readShaderFile(const char* filePath);
 bool gladLoadGL(GLADloadproc gla_dloadproc);
 
 // camera settings
-glm::vec3 cameraPos = glm::vec3(-3.0f, 3.0f, 3.0f);
+glm::vec3 cameraPos = glm::vec3(-3.0f, 12.0f, 3.0f);
 glm::vec3 cameraFront = glm::vec3(0.63f, -0.49f, -0.61f);
 glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);
 
@@ -40,8 +53,6 @@ float pitch = 0.0f;
 float lastX = 400, lastY = 300;
 bool firstMouse = true;
 
-const int CHUNK_SIZE = 10; // Adjust this value as needed
-
 void checkOpenGLError(const char* stmt, const char* fname, const int line)
 {
     if (const GLenum err = glGetError(); err != GL_NO_ERROR)
@@ -56,66 +67,45 @@ void checkOpenGLError(const char* stmt, const char* fname, const int line)
     checkOpenGLError(#stmt, __FILE__, __LINE__); \
 } while (0)
 
-struct CubeHandler {
-    Cube cube;
-    float size;
-    bool isSplit;
-    std::array<CubeHandler*, 8> children{};
-
-    CubeHandler(const Cube& cube_, float s)
-        : cube(cube_), size(s), isSplit(false) {
-        children.fill(nullptr);
-    }
-
-    ~CubeHandler() {
-        // Recursively delete child cubes
-        for (auto child : children) {
-            delete child;
-        }
-    }
-};
-
-struct Layer {
-    int y;
-    std::array<std::array<CubeHandler*, CHUNK_SIZE>, CHUNK_SIZE> cubes;
-
-    Layer(int y_)
-        : y(y_) {
-        for (auto& row : cubes) {
-            row.fill(nullptr);
-        }
-    }
-
-    ~Layer() {
-        for (auto& row : cubes) {
-            for (auto cube : row) {
-                delete cube;
-            }
-        }
-    }
+// How chunks are turned into draw calls
+enum class RenderMode {
+    Cubes,  // one instance per cube
+    Culled, // hidden-face culled chunk mesh
+    Greedy, // culled mesh with coplanar faces merged
+    BinaryGreedy, // same mesh as Greedy, meshed with bitmasks
+    Octree, // one instance per sparse voxel octree leaf
+    Count
 };
-
-struct Chunk {
-    int x, y, z;
-    std::array<Layer*, CHUNK_SIZE> layers;
-
-    Chunk(int x_, int y_, int z_)
-        : x(x_), y(y_), z(z_) {
-        layers.fill(nullptr);
-    }
-
-    ~Chunk() {
-        for (auto layer : layers) {
-            delete layer;
-        }
-    }
+const char* renderModeNames[] = {"Cubes (instanced)", "Culled mesh", "Greedy mesh", "Binary greedy mesh", "Octree leaves"};
+RenderMode renderMode = RenderMode::BinaryGreedy;
+bool showCubeTree = false; // T toggles the test cube tree
+bool occlusionCulling = true; // O toggles the software occlusion culling
+bool connectivityCulling = true; // C toggles walking the chunk connectivity graph
+bool levelOfDetail = true; // L toggles the distance LOD rings
+bool farTerrain = true; // F toggles the clipmap terrain past the loaded chunks
+
+// Chunk rings where LOD 1, 2 and 3 start (40, 70 and 100 voxels, rounded up), see World::setLodDistances
+const std::array<int, MAX_CHUNK_LOD> lodRings = World::lodRingsFromVoxels({40, 70, 100});
+const std::array<int, MAX_CHUNK_LOD> noLodRings = {1000, 1000, 1000};
+
+// Passes timed on the GPU, in the order GpuTimers is given their names
+enum RenderPass { CubeTreePass, ChunkPass, ImGuiPass };
+
+struct RenderStats {
+    int cubes = 0;
+    int triangles = 0;
+    int drawCalls = 0;
+    int planeTests = 0; // frustum plane tests done by the hierarchical culling
+    int lodChunks[MAX_CHUNK_LOD + 1] = {};
+    int lodTriangles[MAX_CHUNK_LOD + 1] = {};
 };
 
-void buildTestCubeTree(CubeHandler& cubeHandler, int maxDepth);
 void buildCubeTree(CubeHandler& cubeHandler, int maxDepth);
-void renderCubes(CubeHandler& cubeHandler, unsigned int shaderProgram, int& n, const Frustum& frustum);
-void generateChunk(Chunk& chunk);
-void renderChunk(Chunk& chunk, unsigned int shaderProgram, int& n, const Frustum& frustum);
+void renderCubes(CubeHandler& cubeHandler, CubeInstanceBuffer& instances, RenderStats& stats, const Frustum& frustum,
+                 unsigned planeMask = FRUSTUM_ALL_PLANES);
+void renderChunk(Chunk& chunk, ChunkRenderData& render, unsigned int shaderProgram, RenderStats& stats);
+void renderChunkCubes(Chunk& chunk, ChunkRenderData& render, unsigned int shaderProgram, RenderStats& stats, const Frustum& frustum);
+void renderOctree(ChunkRenderData& render, unsigned int shaderProgram, RenderStats& stats);
 
 int main() {
     // std::cout << "Current working directory: " << std::filesystem::current_path() << std::endl;
@@ -125,8 +115,8 @@ int main() {
         return -1;
     }
 
-    // Configure GLFW (OpenGL version 3.3, Core profile)
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // Configure GLFW (OpenGL 4.3 Core profile for multi-draw indirect, 3.3 otherwise)
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 #ifdef __APPLE__
@@ -135,6 +125,11 @@ int main() {
 
     // create a window
     GLFWwindow* window = glfwCreateWindow(1200, 800, "Voxel Engine", nullptr, nullptr);
+    if (window == nullptr) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(1200, 800, "Voxel Engine", nullptr, nullptr);
+    }
     if (window == nullptr) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -194,31 +189,52 @@ int main() {
 
     // Register Mouse Callback
     glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetKeyCallback(window, key_callback);
 
     // Initialize cube buffers (call only once)
     Cube::initBuffers();
+    ChunkMesh::initSharedBuffers(MAX_CHUNK_QUADS);
 
     // Use shader program
     glUseProgram(shaderProgram);
 
     // Get uniform locations
     Cube::modelLoc = glGetUniformLocation(shaderProgram, "model");
+    MeshPool::originsLoc = glGetUniformLocation(shaderProgram, "chunkOrigins");
+    MeshPool::packedLoc = glGetUniformLocation(shaderProgram, "packedVertex");
+    MeshPool::pageShiftLoc = glGetUniformLocation(shaderProgram, "pageShift");
     unsigned int viewLoc  = glGetUniformLocation(shaderProgram, "view");
     unsigned int projLoc  = glGetUniformLocation(shaderProgram, "projection");
 
     // std::vector<glm::vec3> cubePositions;
     // float cubeScales[];
     std::vector<Cube> cubes;
-    Cube rootCube(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(1.0f));
-    CubeHandler root(rootCube, 1.0f);
-    // buildTestCubeTree(root, 3);
+    // Test cube tree floating over the terrain, shown with T
+    CubeHandlerArena cubeTreeArena;
+    Cube rootCube(glm::vec3(0.0f, 24.0f, -24.0f), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(16.0f));
+    CubeHandler root(rootCube, 16.0f);
+    buildTestCubeTree(root, 6, &cubeTreeArena);
+    CubeInstanceBuffer cubeTreeInstances;
     // std::vector<Cube> cubes;
     // for (unsigned int i = 0; i < cubeLayers[].size(); i++) {
     //     cubes.push_back(Cube(glm::vec3(cubeLayers[i][0]), glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(cubeLayers[i][1])));
     // }
 
-    Chunk rootChunk(0, 0, 0);
-    generateChunk(rootChunk);
+    // Mesh workers write into this, the render thread only issues buffer copies
+    UploadRing uploadRing(4 * 1024 * 1024);
+
+    // Chunks stream in and out around the camera, generated and meshed on worker threads
+    // Distant chunks are meshed at coarser levels of detail, which pays for the bigger radius
+    // Radii are set in voxels so the view distance doesn't change with CHUNK_SIZE
+    World world(144 / CHUNK_SIZE, 160 / CHUNK_SIZE, std::max(1, 24 / CHUNK_SIZE));
+    world.setMeshingMode(MeshingMode::BinaryGreedy);
+    world.setLodDistances(lodRings);
+    world.setUploadRing(&uploadRing);
+
+    // Heightfield terrain past the loaded chunks, out to a few kilometres
+    ClipmapTerrain clipmap(4, 8);
+
+    GpuTimers gpuTimers({"Cube Tree", "Chunks", "ImGui"});
 
     // Enable depth testing
     glEnable(GL_DEPTH_TEST);
@@ -240,9 +256,18 @@ int main() {
     Frustum frustum;
     float frustumMargin = 0.9f; // Adjust this value as needed
 
+    RenderMode meshedMode = renderMode;
+
+    // Chunk bounds gathered every frame and culled in one batch
+    std::vector<Chunk*> frameChunks;
+    AABBList chunkBounds;
+    std::vector<uint32_t> visibleChunks;
+    OcclusionCuller occlusion;
+
     // Render loop
+    PROFILE_THREAD("Main");
     while (!glfwWindowShouldClose(window)) {
-        int cubeNum = 0;
+        RenderStats stats;
         // Calculate deltaTime
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
@@ -257,6 +282,7 @@ int main() {
 
         // input
         processInput(window);
+        gpuTimers.beginFrame();
 
         // Start the ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
@@ -270,11 +296,14 @@ int main() {
         // Set up the transformation matrices
         glm::mat4 view = glm::lookAt(cameraPos, cameraPos + cameraFront, cameraUp);
         float fov = 90.0f;
-        glm::mat4 projection = glm::perspective(glm::radians(fov), static_cast<float>(1200)/800, 0.1f, 100.0f);
+        glm::mat4 projection = glm::perspective(glm::radians(fov), static_cast<float>(1200)/800, 0.1f, 3000.0f);
         //glm::mat4 model = glm::mat4(1.0f);
 
         // Update the frustum
-        frustum.update(projection * view, frustumMargin);
+        {
+            PROFILE_ZONE("Frustum Update");
+            frustum.update(projection * view, frustumMargin);
+        }
 
         glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
         glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
@@ -288,28 +317,198 @@ int main() {
         //     // Draw the cube
         //     cube.draw(shaderProgram);
         // }
-        // renderCubes(root, shaderProgram, cubeNum);
-        renderChunk(rootChunk, shaderProgram, cubeNum, frustum);
-
-        // Create an ImGui window to display stats
-        ImGui::SetNextWindowPos(ImVec2(10, 10)); // Position at (10,10)
-        ImGui::Begin("Stats", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
-        ImGui::Text("FPS: %f", fps);
-        ImGui::Text("Camera Position: (%.2f, %.2f, %.2f)", cameraPos.x, cameraPos.y, cameraPos.z);
-        ImGui::Text("Camera Direction: (%.2f, %.2f, %.2f)", cameraFront.x, cameraFront.y, cameraFront.z);
-        ImGui::Text("Number of Cubes: %d", cubeNum);
-        ImGui::End();
-
-        // Render ImGui on top of the scene
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        if (showCubeTree) {
+            PROFILE_ZONE("Cube Tree");
+            gpuTimers.begin(CubeTreePass);
+            cubeTreeInstances.clear();
+            renderCubes(root, cubeTreeInstances, stats, frustum);
+            cubeTreeInstances.upload();
+            cubeTreeInstances.draw(shaderProgram);
+            stats.triangles += cubeTreeInstances.size() * 12;
+            stats.drawCalls++;
+            gpuTimers.end(CubeTreePass, cubeTreeInstances.size() * 12, 1);
+        }
+        if (renderMode != meshedMode) {
+            if (renderMode != RenderMode::Cubes) {
+                // Switching mesher invalidates every chunk mesh
+                world.setMeshingMode(renderMode == RenderMode::Culled ? MeshingMode::Culled
+                                   : renderMode == RenderMode::Greedy ? MeshingMode::Greedy
+                                   : renderMode == RenderMode::BinaryGreedy ? MeshingMode::BinaryGreedy
+                                   : MeshingMode::OctreeLeaves);
+                // The cube path overwrites the instance buffers, so rebuild even if the mode didn't change
+                world.markAllDirty();
+            }
+            meshedMode = renderMode;
+        }
+        if (levelOfDetail != (world.getLodDistances() == lodRings)) {
+            world.setLodDistances(levelOfDetail ? lodRings : noLodRings);
+        }
+        world.update(cameraPos);
+        if (farTerrain) {
+            clipmap.update(cameraPos, World::chunkCoordOf(cameraPos), world.loadRadius, world.verticalRadius);
+        }
+
+        size_t chunkMemory = 0;
+        frameChunks.clear();
+        world.forEachChunk([&](const glm::ivec3& coord, Chunk& chunk) {
+            chunkMemory += chunk.blocks.memoryUsage();
+            if (!connectivityCulling) frameChunks.push_back(&chunk);
+        });
+        // Only chunks the camera can see through air (enclosed caves etc. are skipped)
+        if (connectivityCulling) {
+            world.findVisibleChunks(cameraPos, frustum, frameChunks);
+        }
+
+        chunkBounds.clear();
+        for (const Chunk* chunk : frameChunks) {
+            // Cubes are centered on integer positions
+            glm::vec3 origin(chunk->x, chunk->y, chunk->z);
+            chunkBounds.add(origin - 0.5f, origin + (CHUNK_SIZE - 0.5f));
+        }
+        {
+            PROFILE_ZONE("Frustum Culling");
+            frustum.cullAABBIndices(chunkBounds, visibleChunks);
+        }
+        const int frustumVisible = static_cast<int>(visibleChunks.size());
+
+        // The fully solid layers of the visible chunks hide whatever is behind them
+        int occlusionRejected = 0;
+        if (occlusionCulling) {
+            PROFILE_ZONE("Occlusion Culling");
+            occlusion.beginFrame(projection * view);
+            for (uint32_t index : visibleChunks) {
+                const Chunk& chunk = *frameChunks[index];
+                if (chunk.occluderEnd <= chunk.occluderBegin) continue;
+
+                glm::vec3 origin(chunk.x, chunk.y, chunk.z);
+                occlusion.addOccluder(origin + glm::vec3(-0.5f, chunk.occluderBegin - 0.5f, -0.5f),
+                                      origin + glm::vec3(CHUNK_SIZE - 0.5f, chunk.occluderEnd - 0.5f, CHUNK_SIZE - 0.5f));
+            }
+            occlusion.rasterize(&world.jobSystem());
+            occlusionRejected = occlusion.removeOccluded(chunkBounds, visibleChunks);
+        }
+
+        {
+            PROFILE_ZONE("Render Chunks");
+            const int trianglesBefore = stats.triangles;
+            const int drawCallsBefore = stats.drawCalls;
+            gpuTimers.begin(ChunkPass);
+            for (uint32_t index : visibleChunks) {
+                Chunk& chunk = *frameChunks[index];
+                ChunkRenderData& render = world.renderData(chunk);
+                if (renderMode == RenderMode::Cubes) {
+                    renderChunkCubes(chunk, render, shaderProgram, stats, frustum);
+                } else if (renderMode == RenderMode::Octree) {
+                    renderOctree(render, shaderProgram, stats);
+                } else {
+                    renderChunk(chunk, render, shaderProgram, stats);
+                }
+            }
+            if (farTerrain) {
+                clipmap.queueVisible(frustum);
+                stats.triangles += clipmap.trianglesQueued();
+            }
+            stats.drawCalls += ChunkMesh::drawQueued(shaderProgram);
+            gpuTimers.end(ChunkPass, stats.triangles - trianglesBefore, stats.drawCalls - drawCallsBefore);
+        }
+
+        {
+            PROFILE_ZONE("ImGui");
+            // Create an ImGui window to display stats
+            ImGui::SetNextWindowPos(ImVec2(10, 10)); // Position at (10,10)
+            ImGui::Begin("Stats", nullptr, ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize);
+            ImGui::Text("FPS: %f", fps);
+            ImGui::Text("Camera Position: (%.2f, %.2f, %.2f)", cameraPos.x, cameraPos.y, cameraPos.z);
+            ImGui::Text("Camera Direction: (%.2f, %.2f, %.2f)", cameraFront.x, cameraFront.y, cameraFront.z);
+            ImGui::Text("Render Mode: %s (M to cycle)", renderModeNames[static_cast<int>(renderMode)]);
+            ImGui::Text("Number of Cubes: %d", stats.cubes);
+            ImGui::Text("Triangles: %d", stats.triangles);
+            ImGui::Text("Draw Calls: %d", stats.drawCalls);
+            ImGui::Text("Frustum Plane Tests: %d (T toggles cube tree)", stats.planeTests);
+            // Results lag a frame or two behind, the queries are never waited on.
+            // Passes that weren't drawn (the hidden cube tree) keep an old result.
+            double gpuTotalMs = 0.0;
+            for (const GpuTimers::Pass& pass : gpuTimers.passes()) {
+                if (pass.submitted) gpuTotalMs += pass.gpuMs;
+            }
+            ImGui::Text("GPU Passes: %.2f ms of a %.2f ms frame", gpuTotalMs, deltaTime * 1000.0f);
+            for (int pass = 0; pass < static_cast<int>(gpuTimers.passes().size()); pass++) {
+                const GpuTimers::Pass& timing = gpuTimers.passes()[pass];
+                if (!timing.submitted) continue;
+                if (timing.measured) {
+                    ImGui::Text("  %s: GPU %.2f ms, CPU %.2f ms, %d triangles, %d draw calls", timing.name,
+                                timing.gpuMs, timing.cpuMs, timing.triangles, timing.drawCalls);
+                } else {
+                    ImGui::Text("  %s: GPU pending, CPU %.2f ms", timing.name, timing.cpuMs);
+                }
+            }
+            ImGui::Text("Chunks: %d resident, %d loading, %d unloading", world.residentCount(), world.loadingCount(), world.unloadingCount());
+            ImGui::Text("Chunks Visible: %zu (%d after frustum)", visibleChunks.size(), frustumVisible);
+            if (connectivityCulling) {
+                ImGui::Text("Connectivity: %zu of %d chunks reachable (C toggles)", frameChunks.size(), world.residentCount());
+            } else {
+                ImGui::Text("Connectivity: off (C toggles)");
+            }
+            if (occlusionCulling) {
+                ImGui::Text("Occlusion: %d chunks rejected, %d occluders, %d triangles, %.2f ms (O toggles)",
+                            occlusionRejected, occlusion.occluderCount(), occlusion.triangleCount(), occlusion.rasterizeMs());
+            } else {
+                ImGui::Text("Occlusion: off (O toggles)");
+            }
+            if (renderMode == RenderMode::Culled || renderMode == RenderMode::Greedy || renderMode == RenderMode::BinaryGreedy) {
+                ImGui::Text("LOD rings: %s (L toggles)", levelOfDetail ? "on" : "off");
+                for (int lod = 0; lod <= MAX_CHUNK_LOD; lod++) {
+                    ImGui::Text("  LOD %d (%dx): %d chunks, %d triangles", lod, 1 << lod, stats.lodChunks[lod], stats.lodTriangles[lod]);
+                }
+            }
+            if (farTerrain) {
+                ImGui::Text("Far Terrain: %d levels to %.0f, %d columns sampled, %d tiles remeshed, %.1f KB (F toggles)",
+                            clipmap.levelCount(), clipmap.reach(), clipmap.columnsSampled(), clipmap.tilesRemeshed(),
+                            clipmap.memoryUsage() / 1024.0);
+            } else {
+                ImGui::Text("Far Terrain: off (F toggles)");
+            }
+            ImGui::Text("Chunk Memory: %.1f KB", chunkMemory / 1024.0);
+            const MeshPool& meshPool = *ChunkMesh::sharedPool();
+            ImGui::Text("Mesh Pool: %d of %d pages (%.1f MB), %s", meshPool.usedPages(), meshPool.capacityPages(),
+                        meshPool.capacityPages() * MeshPool::PAGE_VERTICES * sizeof(ChunkVertex) / (1024.0 * 1024.0),
+                        meshPool.usesIndirectDraw() ? "multi-draw indirect" : "multi-draw base vertex");
+            ImGui::Text("Upload Ring: %.1f KB copied, %d misses, %s", uploadRing.bytesCopied() / 1024.0,
+                        uploadRing.missedReservations(), uploadRing.isPersistent() ? "persistent mapped" : "orphaned");
+            ImGui::Text("Jobs: %d queued on %d threads, %d meshes scheduled, %d uploaded",
+                        world.jobSystem().pendingJobs(), world.jobSystem().threadCount(), world.meshingCount(), world.uploadsLastFrame());
+            ImGui::End();
+
+            Profiler::drawWindow();
+
+            // Render ImGui on top of the scene
+            ImGui::Render();
+            ImDrawData* drawData = ImGui::GetDrawData();
+            int imguiDrawCalls = 0;
+            for (int i = 0; i < drawData->CmdListsCount; i++) {
+                imguiDrawCalls += drawData->CmdLists[i]->CmdBuffer.Size;
+            }
+            gpuTimers.begin(ImGuiPass);
+            ImGui_ImplOpenGL3_RenderDrawData(drawData);
+            gpuTimers.end(ImGuiPass, drawData->TotalIdxCount / 3, imguiDrawCalls);
+        }
 
         // Swap buffers and poll IO events
-        glfwSwapBuffers(window);
+        {
+            PROFILE_ZONE("Swap");
+            glfwSwapBuffers(window);
+        }
         glfwPollEvents();
+        PROFILE_FRAME();
     }
 
-    // De-allocate resources
+    // De-allocate resources, workers may still be writing into the upload ring
+    world.jobSystem().shutdown();
+    world.clear();
+    uploadRing.cleanup();
+    clipmap.cleanup();
+    cubeTreeInstances.cleanup();
+    gpuTimers.cleanup();
     glDeleteProgram(shaderProgram);
 
     // Cleanup ImGui
@@ -319,12 +518,14 @@ int main() {
 
     // Cleanup
     Cube::cleanup();
+    ChunkMesh::cleanupSharedBuffers();
     glfwTerminate();
     return 0;
 }
 
 // Process all input
 void processInput(GLFWwindow *window) {
+    PROFILE_ZONE("Input");
     float cameraSpeed = 3.0f * deltaTime; // Adjust accordingly
 
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
@@ -430,25 +631,29 @@ void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
     cameraFront = glm::normalize(front);
 }
 
-// Split cube
-void splitCube(CubeHandler& cubeHandler){
-    if (cubeHandler.isSplit) return; // Already split
-    float childSize = cubeHandler.size / 2.0f; // Each child cube is eight the size
-    float offset = childSize / 2.0f; // Offset from the parent cubes center
-
-    int index = 0;
-    for (int dx = -1; dx <= 1; dx+= 2) {
-        for (int dy = -1; dy <= 1; dy += 2) {
-            for (int dz = -1; dz <= 1; dz += 2) {
-                glm::vec3 childPos = cubeHandler.cube.position + glm::vec3(dx*offset, dy*offset, dz*offset);
-                Cube childCube(childPos, glm::vec3(0.0f, 1.0f, 0.0f), 0.0f, glm::vec3(childSize));
-                CubeHandler* newHandler = new CubeHandler(childCube, childSize);
-                cubeHandler.children[index] = newHandler;
-                index++;
-            }
-        }
+// Keys that act once per press rather than every frame
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    if (action != GLFW_PRESS) return;
+
+    if (key == GLFW_KEY_M) {
+        int next = (static_cast<int>(renderMode) + 1) % static_cast<int>(RenderMode::Count);
+        renderMode = static_cast<RenderMode>(next);
+    }
+    if (key == GLFW_KEY_T) {
+        showCubeTree = !showCubeTree;
+    }
+    if (key == GLFW_KEY_O) {
+        occlusionCulling = !occlusionCulling;
+    }
+    if (key == GLFW_KEY_C) {
+        connectivityCulling = !connectivityCulling;
+    }
+    if (key == GLFW_KEY_L) {
+        levelOfDetail = !levelOfDetail;
+    }
+    if (key == GLFW_KEY_F) {
+        farTerrain = !farTerrain;
     }
-    cubeHandler.isSplit = true;
 }
 
 // Build and traverse the cube tree
@@ -467,94 +672,82 @@ void splitCube(CubeHandler& cubeHandler){
 //     }
 // }
 
-// Test build cube tree
-void buildTestCubeTree(CubeHandler& cubeHandler, int maxDepth) {
-    if (maxDepth <= 0) return; // Base case: stop recursion
-
-    splitCube(cubeHandler);
-    int index = 0;
-    for (auto child : cubeHandler.children) {
-        if (index == 0 || index == 3 || index == 5 || index == 7) {
-            if (child != nullptr) {
-                buildTestCubeTree(*child, maxDepth-1);
-            }
+// Collect the visible leaf cubes as instances, drawing happens once per chunk.
+// planeMask holds the frustum planes the parent straddles: planes a node is
+// fully inside of are dropped for its children, and once none are left the
+// whole subtree is emitted without any more tests.
+void renderCubes(CubeHandler& cubeHandler, CubeInstanceBuffer& instances, RenderStats& stats, const Frustum& frustum,
+                 unsigned planeMask) {
+    if (planeMask != 0) {
+        glm::vec3 halfSize(cubeHandler.size / 2.0f);
+        if (frustum.classifyAABB(cubeHandler.cube.position - halfSize, cubeHandler.cube.position + halfSize,
+                                 planeMask, cubeHandler.cullPlane, stats.planeTests) == FrustumTest::Outside) {
+            return;
         }
-        index++;
     }
-}
 
-
-void renderCubes(CubeHandler& cubeHandler, unsigned int shaderProgram, int& n, const Frustum& frustum) {
     if (cubeHandler.isSplit) {
         // Traverse and render child cubes
         for (auto child : cubeHandler.children) {
             if (child != nullptr) {
-                // Check if the child's bounding box is in the frustum
-                glm::vec3 childMin = child->cube.position - (child->size / 2.0f);
-                glm::vec3 childMax = child->cube.position + (child->size / 2.0f);
-                if (frustum.isAABBInFrustum(childMin, childMax)) {
-                    renderCubes(*child, shaderProgram, n, frustum);
-                }
+                renderCubes(*child, instances, stats, frustum, planeMask);
             }
         }
     } else {
-        // Check if the cube is in the frustum before rendering
-        if (frustum.isPointInFrustum(cubeHandler.cube.position)) {
-            // Render the cube
-            cubeHandler.cube.draw(shaderProgram);
-            n++;
-        }
+        // Queue the cube for the instanced draw
+        instances.add(cubeHandler.cube.position, cubeHandler.size);
+        stats.cubes++;
     }
 }
 
-void generateChunk(Chunk& chunk) {
-    int baseX = chunk.x;
-    int baseY = chunk.y;
-    int baseZ = chunk.z;
-
-    for (int layerIndex = 0; layerIndex < CHUNK_SIZE; layerIndex++) {
-        int currentY = baseY + layerIndex;
-        Layer* newLayer = new Layer(currentY);
-        chunk.layers[layerIndex] = newLayer;
+// Queue the chunk's mesh, built and uploaded by the world's chunk pipeline.
+// Chunks reaching the render functions already passed the batch frustum cull;
+// everything queued is drawn at once by ChunkMesh::drawQueued.
+void renderChunk(Chunk& chunk, ChunkRenderData& render, unsigned int shaderProgram, RenderStats& stats) {
+    render.mesh.queueDraw();
+    stats.triangles += render.mesh.triangleCount();
+    stats.lodChunks[chunk.meshLod]++;
+    stats.lodTriangles[chunk.meshLod] += render.mesh.triangleCount();
+}
 
+// Reference path: every cube of the chunk as one instanced draw
+void renderChunkCubes(Chunk& chunk, ChunkRenderData& render, unsigned int shaderProgram, RenderStats& stats, const Frustum& frustum) {
+    // Cubes are centered on integer positions. Only the planes the chunk
+    // straddles are tested per cube, none at all if it is fully inside.
+    glm::vec3 origin(chunk.x, chunk.y, chunk.z);
+    unsigned chunkMask = FRUSTUM_ALL_PLANES;
+    unsigned char rejectPlane = 0; // shared by neighbouring cubes, they tend to fail the same plane
+    frustum.classifyAABB(origin - 0.5f, origin + (CHUNK_SIZE - 0.5f), chunkMask, rejectPlane, stats.planeTests);
+
+    render.instances.clear();
+    for (int y = 0; y < CHUNK_SIZE; y++) {
         for (int x = 0; x < CHUNK_SIZE; x++) {
             for (int z = 0; z < CHUNK_SIZE; z++) {
-                float cubeX = baseX + x;
-                float cubeY = currentY;
-                float cubeZ = baseZ + z;
-
-                // Create the cube at the calculated position
-                Cube cube(glm::vec3(cubeX, cubeY, cubeZ),
-                          glm::vec3(0.0f, 1.0f, 0.0f),
-                          0.0f,
-                          glm::vec3(1.0f));
-                CubeHandler* newCubeHandler = new CubeHandler(cube, 1.0f);
-
-                newLayer->cubes[x][z] = newCubeHandler;
+                if (!chunk.isSolid(x, y, z)) continue;
+
+                glm::vec3 position = origin + glm::vec3(x, y, z);
+                unsigned planeMask = chunkMask;
+                if (planeMask == 0 || frustum.classifyAABB(position - 0.5f, position + 0.5f, planeMask, rejectPlane,
+                                                           stats.planeTests) != FrustumTest::Outside) {
+                    render.instances.add(position, 1.0f);
+                    stats.cubes++;
+                }
             }
         }
     }
-}
-
-void renderChunk(Chunk& chunk, unsigned int shaderProgram, int& n, const Frustum& frustum) {
-    glm::vec3 chunkMin(chunk.x, chunk.y, chunk.z);
-    glm::vec3 chunkMax(chunk.x + CHUNK_SIZE, chunk.y + CHUNK_SIZE, chunk.z + CHUNK_SIZE);
 
-    // Check if the entire chunk is in the frustum
-    if (!frustum.isAABBInFrustum(chunkMin, chunkMax)) {
-        return; // Skip this chunk if its not in the frustum
-    }
+    // One draw call for the whole chunk
+    render.instances.upload();
+    render.instances.draw(shaderProgram);
+    stats.triangles += render.instances.size() * 12;
+    stats.drawCalls++;
+}
 
-    for (auto layer : chunk.layers) {
-        if (layer != nullptr) {
-            for (int x = 0; x < CHUNK_SIZE; x++) {
-                for (int z = 0; z < CHUNK_SIZE; z++) {
-                    CubeHandler* cube = layer->cubes[x][z];
-                    if (cube != nullptr) {
-                        renderCubes(*cube, shaderProgram, n, frustum);
-                    }
-                }
-            }
-        }
-    }
-}
\ No newline at end of file
+// Every non-empty octree leaf of the chunk as one scaled cube instance
+void renderOctree(ChunkRenderData& render, unsigned int shaderProgram, RenderStats& stats) {
+    // The leaf instances are built and uploaded by the world's chunk pipeline
+    render.instances.draw(shaderProgram);
+    stats.cubes += render.instances.uploadedSize();
+    stats.triangles += render.instances.uploadedSize() * 12;
+    stats.drawCalls++;
+}
@@ -1,9 +1,27 @@
 #version 330 core
 in vec3 ourColor;       // Input from vertex shader
+flat in uint blockId;   // 0 = ourColor is the color, otherwise ourColor is the light
 
 out vec4 FragColor;     // Output color
 
+// Color of each block id, the last entry for ids without one (CHUNK_VERTEX_MAX_BLOCK
+// stands in for ids too wide for the packed vertex)
+const vec3 blockColors[8] = vec3[8](
+    vec3(0.0, 0.0, 0.0),    // air, never meshed
+    vec3(0.5, 0.5, 0.52),   // stone
+    vec3(0.35, 0.6, 0.25),
+    vec3(0.55, 0.4, 0.25),
+    vec3(0.85, 0.8, 0.55),
+    vec3(0.3, 0.45, 0.75),
+    vec3(0.75, 0.3, 0.25),
+    vec3(1.0, 0.0, 1.0)     // unknown
+);
+
 void main()
 {
-    FragColor = vec4(ourColor, 1.0); // Set the fragment color
+    vec3 color = ourColor;
+    if (blockId != 0u) {
+        color *= blockColors[min(blockId, 7u)];
+    }
+    FragColor = vec4(color, 1.0); // Set the fragment color
 }
\ No newline at end of file
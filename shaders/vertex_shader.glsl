@@ -1,15 +1,40 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;    // Position attribute
-layout (location = 1) in vec3 aColor;  // Color attribute
+layout (location = 0) in vec3 aPos;      // Position attribute
+layout (location = 1) in vec3 aColor;    // Color attribute
+layout (location = 2) in vec4 aInstance; // Per-instance offset (xyz) and scale (w)
+layout (location = 3) in uint aPacked;   // Packed chunk mesh vertex, layout in ChunkVertex.h
 
 out vec3 ourColor; // Output to fragment shader
+flat out uint blockId; // chunk meshes: block id for the fragment shader's palette, 0 for the cube paths
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+uniform bool packedVertex; // chunk meshes use aPacked instead of aPos/aColor
+uniform samplerBuffer chunkOrigins; // min corner (xyz) and scale (w) of each MeshPool page
+uniform int pageShift; // log2 of the vertices per page, MeshPool::PAGE_SHIFT
+
+// Light on each face, -X +X -Y +Y -Z +Z, so the faces of a block stay apart
+const float faceLight[6] = float[6](0.8, 0.8, 0.55, 1.0, 0.7, 0.7);
+// Light left at each ambient occlusion level (0 = open)
+const float occlusionLight[4] = float[4](1.0, 0.75, 0.55, 0.4);
+
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0); // Set the vertex position
+    if (packedVertex) {
+        vec3 localPos = vec3(aPacked & 127u, (aPacked >> 7) & 127u, (aPacked >> 14) & 127u);
+        uint face = (aPacked >> 21) & 7u;
+        uint occlusion = (aPacked >> 24) & 3u;
+        vec4 origin = texelFetch(chunkOrigins, gl_VertexID >> pageShift);
+        gl_Position = projection * view * vec4(origin.xyz + localPos * origin.w, 1.0);
+        ourColor = vec3(faceLight[face] * occlusionLight[occlusion]);
+        blockId = aPacked >> 26;
+        return;
+    }
+
+    vec3 worldPos = aPos * aInstance.w + aInstance.xyz;
+    gl_Position = projection * view * model * vec4(worldPos, 1.0); // Set the vertex position
     ourColor = aColor;             // Pass the color to the fragment shader
-}
\ No newline at end of file
+    blockId = 0u;
+}
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../ChunkMesher.h"
+
+namespace {
+
+using Quad = std::array<ChunkVertex, 4>;
+
+// Quads of a mesh in a canonical order, for comparing meshes that emit them in different orders
+std::vector<Quad> sortedQuads(const std::vector<ChunkVertex>& vertices) {
+    std::vector<Quad> quads;
+    for (size_t i = 0; i + 3 < vertices.size(); i += 4) {
+        quads.push_back({vertices[i], vertices[i + 1], vertices[i + 2], vertices[i + 3]});
+    }
+    std::sort(quads.begin(), quads.end());
+    return quads;
+}
+
+// About two thirds solid, blocks drawn from 1..types
+template <int Size>
+std::unique_ptr<BasicChunk<Size>> randomChunk(unsigned seed, int types) {
+    std::mt19937 rng(seed);
+    auto chunk = std::make_unique<BasicChunk<Size>>(0, 0, 0);
+    for (int y = 0; y < Size; y++) {
+        for (int x = 0; x < Size; x++) {
+            for (int z = 0; z < Size; z++) {
+                const BlockId block = rng() % 3 == 0 ? BLOCK_AIR : static_cast<BlockId>(1 + rng() % types);
+                chunk->set(x, y, z, block);
+            }
+        }
+    }
+    return chunk;
+}
+
+struct Meshes {
+    std::vector<ChunkVertex> greedy, binaryGreedy;
+};
+
+template <int Size>
+Meshes buildBoth(const BasicChunk<Size>& chunk, const BasicChunkNeighbours<Size>& neighbours) {
+    Meshes meshes;
+    buildGreedyMesh<Size>(chunk, neighbours, meshes.greedy);
+    buildBinaryGreedyMesh<Size>(chunk, neighbours, meshes.binaryGreedy);
+    return meshes;
+}
+
+// Single block type: the binary mesher promises the same quads in the same order
+template <int Size>
+void expectSameOrderForOneType() {
+    for (unsigned seed = 0; seed < 4; seed++) {
+        const auto chunk = randomChunk<Size>(seed, 1);
+        const Meshes meshes = buildBoth<Size>(*chunk, {});
+        EXPECT_FALSE(meshes.greedy.empty());
+        EXPECT_EQ(meshes.greedy, meshes.binaryGreedy) << "seed " << seed;
+    }
+}
+
+// Two block types: same quads, the order may differ
+template <int Size>
+void expectSameQuadsForTwoTypes() {
+    for (unsigned seed = 0; seed < 4; seed++) {
+        const auto chunk = randomChunk<Size>(seed, 2);
+        const Meshes meshes = buildBoth<Size>(*chunk, {});
+        EXPECT_EQ(sortedQuads(meshes.greedy), sortedQuads(meshes.binaryGreedy)) << "seed " << seed;
+    }
+}
+
+// A +X neighbour hides part of the chunk's +X border faces, both meshers must agree on which
+template <int Size>
+void expectSameQuadsWithNeighbour() {
+    for (unsigned seed = 0; seed < 4; seed++) {
+        const auto chunk = randomChunk<Size>(seed, 2);
+        const auto neighbour = randomChunk<Size>(seed + 100, 2);
+        BasicChunkNeighbours<Size> neighbours{};
+        neighbours[1] = neighbour.get();
+
+        const Meshes meshes = buildBoth<Size>(*chunk, neighbours);
+        EXPECT_EQ(sortedQuads(meshes.greedy), sortedQuads(meshes.binaryGreedy)) << "seed " << seed;
+
+        // The neighbour must actually change the mesh for this to test anything
+        std::vector<ChunkVertex> alone;
+        buildGreedyMesh<Size>(*chunk, {}, alone);
+        EXPECT_NE(sortedQuads(meshes.greedy), sortedQuads(alone)) << "seed " << seed;
+    }
+}
+
+}
+
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyOneType16) { expectSameOrderForOneType<16>(); }
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyOneType32) { expectSameOrderForOneType<32>(); }
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyOneType64) { expectSameOrderForOneType<64>(); }
+
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyTwoTypes16) { expectSameQuadsForTwoTypes<16>(); }
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyTwoTypes32) { expectSameQuadsForTwoTypes<32>(); }
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyTwoTypes64) { expectSameQuadsForTwoTypes<64>(); }
+
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyWithNeighbour16) { expectSameQuadsWithNeighbour<16>(); }
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyWithNeighbour32) { expectSameQuadsWithNeighbour<32>(); }
+TEST(ChunkMesher, BinaryGreedyMatchesGreedyWithNeighbour64) { expectSameQuadsWithNeighbour<64>(); }
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "../OcclusionCuller.h"
+
+namespace {
+
+// Camera at the origin looking down -Z
+glm::mat4 viewProjection() {
+    const glm::mat4 projection = glm::perspective(glm::radians(70.0f), 2.0f, 0.1f, 500.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    return projection * view;
+}
+
+// A 16x16 wall, 20 units in front of the camera
+void addWall(OcclusionCuller& culler) {
+    culler.addOccluder(glm::vec3(-8.0f, -8.0f, -21.0f), glm::vec3(8.0f, 8.0f, -20.0f));
+}
+
+// Random boxes in front of the camera
+std::vector<std::pair<glm::vec3, glm::vec3>> randomBoxes(unsigned seed, int count, float minSize, float maxSize) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> lateral(-30.0f, 30.0f);
+    std::uniform_real_distribution<float> depth(-80.0f, -5.0f);
+    std::uniform_real_distribution<float> size(minSize, maxSize);
+    std::vector<std::pair<glm::vec3, glm::vec3>> boxes;
+    for (int i = 0; i < count; i++) {
+        const glm::vec3 minPoint(lateral(rng), lateral(rng) * 0.5f, depth(rng));
+        boxes.emplace_back(minPoint, minPoint + glm::vec3(size(rng), size(rng), size(rng)));
+    }
+    return boxes;
+}
+
+}
+
+TEST(OcclusionCuller, WallHidesBoxBehindIt) {
+    OcclusionCuller culler;
+    culler.beginFrame(viewProjection());
+    addWall(culler);
+    culler.rasterize();
+
+    EXPECT_FALSE(culler.isAABBVisible(glm::vec3(-1.0f, -1.0f, -31.0f), glm::vec3(1.0f, 1.0f, -29.0f)));
+}
+
+TEST(OcclusionCuller, BoxesBesideAndInFrontOfWallStayVisible) {
+    OcclusionCuller culler;
+    culler.beginFrame(viewProjection());
+    addWall(culler);
+    culler.rasterize();
+
+    EXPECT_TRUE(culler.isAABBVisible(glm::vec3(20.0f, -1.0f, -31.0f), glm::vec3(22.0f, 1.0f, -29.0f)));
+    EXPECT_TRUE(culler.isAABBVisible(glm::vec3(-1.0f, 12.0f, -31.0f), glm::vec3(1.0f, 14.0f, -29.0f)));
+    EXPECT_TRUE(culler.isAABBVisible(glm::vec3(-1.0f, -1.0f, -11.0f), glm::vec3(1.0f, 1.0f, -9.0f)));
+}
+
+TEST(OcclusionCuller, BoxStraddlingNearPlaneIsKept) {
+    OcclusionCuller culler;
+    culler.beginFrame(viewProjection());
+    addWall(culler);
+    culler.rasterize();
+
+    // Reaches from behind the camera to behind the wall
+    EXPECT_TRUE(culler.isAABBVisible(glm::vec3(-1.0f, -1.0f, -30.0f), glm::vec3(1.0f, 1.0f, 0.5f)));
+}
+
+TEST(OcclusionCuller, RemoveOccludedKeepsVisibleIndices) {
+    OcclusionCuller culler;
+    culler.beginFrame(viewProjection());
+    addWall(culler);
+    culler.rasterize();
+
+    AABBList boxes;
+    boxes.add(glm::vec3(-1.0f, -1.0f, -31.0f), glm::vec3(1.0f, 1.0f, -29.0f)); // behind
+    boxes.add(glm::vec3(20.0f, -1.0f, -31.0f), glm::vec3(22.0f, 1.0f, -29.0f)); // beside
+    boxes.add(glm::vec3(-1.0f, -1.0f, -11.0f), glm::vec3(1.0f, 1.0f, -9.0f)); // in front
+    std::vector<uint32_t> indices = {0, 1, 2};
+
+    EXPECT_EQ(culler.removeOccluded(boxes, indices), 1);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{1, 2}));
+}
+
+TEST(OcclusionCuller, SimdMatchesScalar) {
+    OcclusionCuller simd, scalar;
+    simd.setSimd(true);
+    scalar.setSimd(false);
+    if (!simd.usesSimd()) GTEST_SKIP() << "built without SSE2";
+
+    const auto occluders = randomBoxes(1, 40, 2.0f, 12.0f);
+    for (OcclusionCuller* culler : {&simd, &scalar}) {
+        culler->beginFrame(viewProjection());
+        for (const auto& [minPoint, maxPoint] : occluders) culler->addOccluder(minPoint, maxPoint);
+        culler->rasterize();
+    }
+
+    const std::vector<float>& simdDepth = simd.depthBuffer();
+    const std::vector<float>& scalarDepth = scalar.depthBuffer();
+    ASSERT_EQ(simdDepth.size(), scalarDepth.size());
+    int covered = 0;
+    for (size_t i = 0; i < simdDepth.size(); i++) {
+        EXPECT_EQ(simdDepth[i] > 0.0f, scalarDepth[i] > 0.0f) << "pixel " << i;
+        EXPECT_NEAR(simdDepth[i], scalarDepth[i], 1e-6f * scalarDepth[i]) << "pixel " << i;
+        covered += scalarDepth[i] > 0.0f;
+    }
+    EXPECT_GT(covered, 0);
+
+    for (const auto& [minPoint, maxPoint] : randomBoxes(2, 200, 0.5f, 4.0f)) {
+        EXPECT_EQ(simd.isAABBVisible(minPoint, maxPoint), scalar.isAABBVisible(minPoint, maxPoint));
+    }
+}